@@ -0,0 +1,71 @@
+/**
+ * @file RootParallel.cpp
+ * @brief Measures how root parallel MCTS scales with the number of threads.
+ *
+ * For every thread count, a number of test games is played with a fixed time per move. The benchmark reports the
+ * number of iterations per second over all threads and the average score of the games, which measures the quality of
+ * the moves.
+ *
+ * Usage: cpp_mcts_benchmark_root_parallel [max threads] [time per move in ms] [games]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "TestGame.hpp"
+#include "mcts/parallel.hpp"
+
+using TestGameRootParallelMCTS = RootParallelMCTS<TestGameState, TestGameAction, TestGameExpansionStrategy,
+    TestGamePlayoutStrategy>;
+
+static const uint NUM_TURNS = 10;
+static const uint MAX_CHOICE = 9;
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = argc > 1 ? (unsigned int)std::atoi(argv[1]) : std::max(1U, std::thread::hardware_concurrency());
+    int timePerMove = argc > 2 ? std::atoi(argv[2]) : 20;
+    int numGames = argc > 3 ? std::atoi(argv[3]) : 10;
+
+    std::printf("%8s %16s %12s\n", "threads", "iterations/s", "avg score");
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+        unsigned long long iterations = 0;
+        double searchSeconds = 0;
+        float totalScore = 0;
+
+        for (int game = 0; game < numGames; game++) {
+            std::mt19937 generator(game);
+            std::uniform_int_distribution<uint> distribution(0, MAX_CHOICE);
+            std::vector<uint> expectedSequence(NUM_TURNS);
+            for (auto& entry : expectedSequence)
+                entry = distribution(generator);
+
+            TestGameState state(NUM_TURNS, MAX_CHOICE);
+            auto factory = [&expectedSequence](const TestGameState& root) {
+                return TestGameMCTS(root, new TestGameBackPropagation(), new TestGameTerminationCheck(),
+                    new TestGameScoring(expectedSequence));
+            };
+            TestGameRootParallelMCTS mcts(state, threads, factory, (unsigned int)game * maxThreads);
+            mcts.setTime(timePerMove);
+
+            for (uint turn = 0; turn < NUM_TURNS; turn++) {
+                auto start = std::chrono::steady_clock::now();
+                auto action = mcts.calculateAction();
+                searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                iterations += mcts.getIterations();
+
+                action.execute(state);
+                mcts.advance(action);
+            }
+
+            totalScore += TestGameScoring(expectedSequence).score(state);
+        }
+
+        std::printf("%8u %16.0f %12.3f\n", threads, (double)iterations / searchSeconds, totalScore / (float)numGames);
+    }
+
+    return 0;
+}
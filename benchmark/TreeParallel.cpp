@@ -0,0 +1,71 @@
+/**
+ * @file TreeParallel.cpp
+ * @brief Measures how tree parallel MCTS scales with the number of threads.
+ *
+ * For every thread count, a number of test games is played with a fixed time per move. The benchmark reports the
+ * number of iterations per second over all threads, the average score of the games, which measures the quality of
+ * the moves, and the average size of the shared tree after a search.
+ *
+ * Usage: cpp_mcts_benchmark_tree_parallel [max threads] [time per move in ms] [games] [virtual loss]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "TestGame.hpp"
+
+static const uint NUM_TURNS = 10;
+static const uint MAX_CHOICE = 9;
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = argc > 1 ? (unsigned int)std::atoi(argv[1]) : std::max(1U, std::thread::hardware_concurrency());
+    int timePerMove = argc > 2 ? std::atoi(argv[2]) : 20;
+    int numGames = argc > 3 ? std::atoi(argv[3]) : 10;
+    int virtualLoss = argc > 4 ? std::atoi(argv[4]) : 1;
+
+    std::printf("%8s %16s %12s %12s\n", "threads", "iterations/s", "avg score", "avg nodes");
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+        unsigned long long iterations = 0;
+        unsigned long long nodes = 0;
+        double searchSeconds = 0;
+        float totalScore = 0;
+
+        for (int game = 0; game < numGames; game++) {
+            std::mt19937 generator(game);
+            std::uniform_int_distribution<uint> distribution(0, MAX_CHOICE);
+            std::vector<uint> expectedSequence(NUM_TURNS);
+            for (auto& entry : expectedSequence)
+                entry = distribution(generator);
+
+            TestGameState state(NUM_TURNS, MAX_CHOICE);
+            TestGameMCTS mcts(state, new TestGameBackPropagation(), new TestGameTerminationCheck(),
+                new TestGameScoring(expectedSequence));
+            mcts.setNumThreads(threads);
+            mcts.setVirtualLoss(virtualLoss);
+            mcts.setSeed((unsigned int)game * maxThreads);
+            mcts.setTime(timePerMove);
+
+            for (uint turn = 0; turn < NUM_TURNS; turn++) {
+                auto start = std::chrono::steady_clock::now();
+                auto action = mcts.calculateAction();
+                searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                iterations += mcts.getIterations();
+                nodes += mcts.getNumNodes();
+
+                action.execute(state);
+                mcts.advance(action);
+            }
+
+            totalScore += TestGameScoring(expectedSequence).score(state);
+        }
+
+        std::printf("%8u %16.0f %12.3f %12llu\n", threads, (double)iterations / searchSeconds,
+            totalScore / (float)numGames, nodes / ((unsigned long long)numGames * NUM_TURNS));
+    }
+
+    return 0;
+}
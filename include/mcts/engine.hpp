@@ -0,0 +1,399 @@
+#ifndef CPP_MCTS_ENGINE_HPP
+#define CPP_MCTS_ENGINE_HPP
+
+#include "mcts.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The metrics of the requests of one session class of a SearchEngine
+ */
+struct SessionClassMetrics {
+    /** The number of requests waiting for a worker */
+    std::size_t queued = 0;
+    /** The number of requests that have ended, including failed requests */
+    std::uint64_t completed = 0;
+    /** The number of completed requests that ended after their deadline */
+    std::uint64_t deadlineMisses = 0;
+    /** The number of requests whose search threw an exception */
+    std::uint64_t failed = 0;
+    /** The median time from submitting a request to its action, over the most recent requests */
+    std::chrono::microseconds p50Latency { 0 };
+    /** The 99th percentile of the time from submitting a request to its action, over the most recent requests */
+    std::chrono::microseconds p99Latency { 0 };
+};
+
+/**
+ * @brief Searches the positions of many games at once on one ThreadPool
+ *
+ * Sessions, e.g. the games served by one process, submit the state to search
+ * from together with the time they can wait for the action. Every request is
+ * searched by its own tree on one of the workers of the pool. Trees are
+ * created by a user supplied factory and kept when their request ends. The
+ * next request of the same session class resets a kept tree to its state
+ * (see MCTS::reset()), which reuses the memory of its nodes. Free workers take the request with the earliest
+ * deadline first, and the search of a request ends shortly before its
+ * deadline. The action is returned through a future or a callback.
+ *
+ * Requests are grouped in session classes, e.g. by time control, and the
+ * engine reports the queue depth, deadline misses and latency of each class.
+ *
+ * @tparam T The State type this engine operates on
+ * @tparam A The Action type this engine operates on
+ * @tparam E The ExpansionStrategy the trees use
+ * @tparam P The PlayoutStrategy the trees use
+ * @tparam B The Backpropagation the trees use
+ * @tparam TC The TerminationCheck the trees use
+ * @tparam S The Scoring the trees use
+ */
+template <class T, class A, class E, class P, class B = Backpropagation<T>, class TC = TerminationCheck<T>,
+    class S = Scoring<T>>
+class SearchEngine {
+public:
+    /** The type of the tree searched for each request */
+    using Tree = MCTS<T, A, E, P, B, TC, S>;
+
+    /**
+     * Creates a tree searching from the given root state. The tree is reused
+     * for later requests of the same session class from other states.
+     */
+    using Factory = std::function<Tree(const T& rootData)>;
+
+    /**
+     * Receives the action of a request, or the exception thrown by its search
+     * in error, which is nullptr when the search succeeded. The action is
+     * default constructed when the search failed.
+     */
+    using Callback = std::function<void(const A& action, std::exception_ptr error)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /** The number of recent latencies per session class the percentiles are computed over */
+    const std::size_t LATENCY_WINDOW = 1024;
+
+    struct Request {
+        T rootData;
+        Clock::time_point submitted;
+        Clock::time_point deadline;
+        /** Orders requests with the same deadline by submission */
+        std::uint64_t sequence;
+        std::string sessionClass;
+        /** Receives the action when there is no callback */
+        std::promise<A> promise;
+        Callback callback;
+
+        Request(const T& rootData, Clock::time_point submitted, Clock::time_point deadline, std::uint64_t sequence,
+            std::string sessionClass, Callback callback)
+            : rootData(rootData)
+            , submitted(submitted)
+            , deadline(deadline)
+            , sequence(sequence)
+            , sessionClass(std::move(sessionClass))
+            , callback(std::move(callback))
+        {
+        }
+    };
+
+    /** Puts the request with the earliest deadline at the top of the heap */
+    struct Later {
+        bool operator()(const std::unique_ptr<Request>& a, const std::unique_ptr<Request>& b) const
+        {
+            return a->deadline > b->deadline || (a->deadline == b->deadline && a->sequence > b->sequence);
+        }
+    };
+
+    struct ClassStatistics {
+        std::size_t queued = 0;
+        std::uint64_t completed = 0;
+        std::uint64_t deadlineMisses = 0;
+        std::uint64_t failed = 0;
+        /** The most recent latencies, overwritten in a circle once LATENCY_WINDOW are stored */
+        std::vector<Clock::duration> latencies;
+        std::size_t nextLatency = 0;
+    };
+
+    Factory factory;
+
+    std::shared_ptr<ThreadPool> threadPool;
+
+    /** The time kept between the end of a search and the deadline of its request */
+    Clock::duration deadlineMargin = std::chrono::milliseconds(1);
+
+    /** Guards all members below */
+    mutable std::mutex mutex;
+
+    /** Signalled when the last request has ended */
+    std::condition_variable idle;
+
+    /** Requests waiting for a worker, a heap ordered by Later */
+    std::vector<std::unique_ptr<Request>> queue;
+
+    std::uint64_t nextSequence = 0;
+
+    /** The number of requests taken from the queue that have not ended yet */
+    std::size_t running = 0;
+
+    std::map<std::string, ClassStatistics> statistics;
+
+    /** Trees of ended requests per session class, reused by the next requests of the class */
+    std::map<std::string, std::vector<std::unique_ptr<Tree>>> idleTrees;
+
+public:
+    /**
+     * @param factory Creates the trees searching the requests
+     * @param numWorkers The number of threads searching requests at once
+     */
+    SearchEngine(Factory factory, unsigned int numWorkers)
+        : SearchEngine(std::move(factory), std::make_shared<ThreadPool>(numWorkers))
+    {
+    }
+
+    /**
+     * @param factory Creates the trees searching the requests
+     * @param pool The pool searching the requests, which may be shared. The
+     * trees use it as well, see MCTS::setThreadPool(). A pool without workers
+     * searches every request right away on the thread submitting it.
+     */
+    SearchEngine(Factory factory, std::shared_ptr<ThreadPool> pool)
+        : factory(std::move(factory))
+        , threadPool(std::move(pool))
+    {
+    }
+
+    SearchEngine(const SearchEngine& other) = delete;
+    SearchEngine& operator=(const SearchEngine& other) = delete;
+
+    /**
+     * @brief Wait until all submitted requests have ended
+     */
+    ~SearchEngine() { wait(); }
+
+    /**
+     * @brief Search for the action to play in the given state
+     *
+     * @param rootData The state to search from
+     * @param budget The time until the action is needed, starting now
+     * @param sessionClass The class the metrics of this request are counted in
+     * @return Becomes ready with the action, or with the exception thrown by
+     * the search
+     */
+    std::future<A> submit(const T& rootData, std::chrono::milliseconds budget, const std::string& sessionClass = std::string())
+    {
+        std::unique_ptr<Request> request = createRequest(rootData, budget, sessionClass, nullptr);
+        std::future<A> result = request->promise.get_future();
+        enqueue(std::move(request));
+        return result;
+    }
+
+    /**
+     * @brief Search for the action to play in the given state
+     *
+     * @param rootData The state to search from
+     * @param budget The time until the action is needed, starting now
+     * @param sessionClass The class the metrics of this request are counted in
+     * @param callback Called with the action, or with the exception thrown by
+     * the search, on the thread that searched it. Should not throw: the
+     * request still ends, but the exception leaves the task of the pool.
+     */
+    void submit(const T& rootData, std::chrono::milliseconds budget, const std::string& sessionClass, Callback callback)
+    {
+        enqueue(createRequest(rootData, budget, sessionClass, std::move(callback)));
+    }
+
+    /**
+     * @brief Wait until all submitted requests have ended
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return queue.empty() && running == 0; });
+    }
+
+    /**
+     * @return The number of requests waiting for a worker
+     */
+    std::size_t getQueueDepth() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+
+    /**
+     * @return The metrics of every session class a request was submitted in
+     */
+    std::map<std::string, SessionClassMetrics> getMetrics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, SessionClassMetrics> metrics;
+        for (const auto& entry : statistics) {
+            const ClassStatistics& s = entry.second;
+            SessionClassMetrics& m = metrics[entry.first];
+            m.queued = s.queued;
+            m.completed = s.completed;
+            m.deadlineMisses = s.deadlineMisses;
+            m.failed = s.failed;
+            m.p50Latency = percentile(s.latencies, 50);
+            m.p99Latency = percentile(s.latencies, 99);
+        }
+        return metrics;
+    }
+
+    /**
+     * @brief Set the time kept between the end of a search and the deadline of its request
+     *
+     * A search ends a little after its allowed time has passed and the
+     * action has to be delivered, so searching until the deadline would miss
+     * it. 1 millisecond by default.
+     *
+     * @param margin The time taken off the budget of every search
+     */
+    void setDeadlineMargin(std::chrono::microseconds margin) { this->deadlineMargin = margin; }
+
+    /**
+     * @return The pool searching the requests
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const { return threadPool; }
+
+private:
+    std::unique_ptr<Request> createRequest(const T& rootData, std::chrono::milliseconds budget, const std::string& sessionClass, Callback callback)
+    {
+        Clock::time_point now = Clock::now();
+        std::uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sequence = nextSequence++;
+        }
+        return std::unique_ptr<Request>(new Request(rootData, now, now + budget, sequence, sessionClass, std::move(callback)));
+    }
+
+    void enqueue(std::unique_ptr<Request> request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            statistics[request->sessionClass].queued++;
+            queue.push_back(std::move(request));
+            std::push_heap(queue.begin(), queue.end(), Later());
+        }
+
+        // Every task searches the most urgent request, not necessarily the one submitted with it
+        threadPool->submit([this]() { searchNext(); });
+    }
+
+    /** Ends a running request when searchNext() returns, even by an exception of a callback */
+    struct Running {
+        SearchEngine* engine;
+
+        ~Running()
+        {
+            std::lock_guard<std::mutex> lock(engine->mutex);
+            engine->running--;
+            if (engine->queue.empty() && engine->running == 0)
+                engine->idle.notify_all();
+        }
+    };
+
+    void searchNext()
+    {
+        std::unique_ptr<Request> request;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::pop_heap(queue.begin(), queue.end(), Later());
+            request = std::move(queue.back());
+            queue.pop_back();
+            statistics[request->sessionClass].queued--;
+            running++;
+        }
+        Running guard { this };
+
+        A action;
+        std::exception_ptr error;
+        std::unique_ptr<Tree> tree;
+        try {
+            tree = takeTree(request->sessionClass, request->rootData);
+            tree->setSeed((unsigned int)request->sequence);
+            tree->setThreadPool(threadPool);
+
+            // A request whose deadline has passed is answered as fast as possible
+            auto time = std::chrono::duration_cast<std::chrono::milliseconds>(request->deadline - deadlineMargin - Clock::now());
+            tree->setTime((int)std::max<std::chrono::milliseconds::rep>(time.count(), 0));
+            action = tree->calculateAction();
+        } catch (...) {
+            error = std::current_exception();
+            // A tree whose search failed is not trusted with another request
+            tree = nullptr;
+        }
+
+        // Count the request before delivering it, so the metrics include every delivered action
+        Clock::time_point end = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tree)
+                idleTrees[request->sessionClass].push_back(std::move(tree));
+
+            ClassStatistics& s = statistics[request->sessionClass];
+            s.completed++;
+            if (end > request->deadline)
+                s.deadlineMisses++;
+            if (error) {
+                s.failed++;
+            } else if (s.latencies.size() < LATENCY_WINDOW) {
+                s.latencies.push_back(end - request->submitted);
+            } else {
+                s.latencies[s.nextLatency] = end - request->submitted;
+                s.nextLatency = (s.nextLatency + 1) % LATENCY_WINDOW;
+            }
+        }
+
+        if (request->callback)
+            request->callback(action, error);
+        else if (error)
+            request->promise.set_exception(error);
+        else
+            request->promise.set_value(action);
+    }
+
+    /** @return A tree of the session class reset to the given state, or a new tree if none is idle */
+    std::unique_ptr<Tree> takeTree(const std::string& sessionClass, const T& rootData)
+    {
+        std::unique_ptr<Tree> tree;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<std::unique_ptr<Tree>>& trees = idleTrees[sessionClass];
+            if (!trees.empty()) {
+                tree = std::move(trees.back());
+                trees.pop_back();
+            }
+        }
+
+        if (tree)
+            tree->reset(rootData);
+        else
+            tree.reset(new Tree(factory(rootData)));
+        return tree;
+    }
+
+    /** @return The given percentile of the latencies, 0 when there are none */
+    static std::chrono::microseconds percentile(std::vector<Clock::duration> latencies, unsigned int p)
+    {
+        if (latencies.empty())
+            return std::chrono::microseconds(0);
+
+        auto nth = latencies.begin() + (std::ptrdiff_t)((latencies.size() - 1) * p / 100);
+        std::nth_element(latencies.begin(), nth, latencies.end());
+        return std::chrono::duration_cast<std::chrono::microseconds>(*nth);
+    }
+};
+
+#endif // CPP_MCTS_ENGINE_HPP
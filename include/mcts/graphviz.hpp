@@ -11,11 +11,11 @@ using namespace std;
 
 /**
  * Function writing out a Graphviz .dot file of an MCTS tree. Useful for debugging.
- * @param root Root of the MCTS tree
+ * @param mcts The MCTS instance whose tree should be written
  * @param filename Filename to write the .dot file to
  */
-template <class T, class A, class G>
-void writeDotFile(Node<T, A, G>* root, const char* filename)
+template <class T, class A, class E, class P, class B, class TC, class S>
+void writeDotFile(const MCTS<T, A, E, P, B, TC, S>& mcts, const char* filename)
 {
     ofstream dot;
     dot.open(filename);
@@ -23,26 +23,31 @@ void writeDotFile(Node<T, A, G>* root, const char* filename)
     // write header
     dot << "digraph MCTS {" << endl;
 
-    vector<Node<T, A, G>*> fringe;
-    fringe.push_back(root);
+    vector<NodeIndex> fringe;
+    fringe.push_back(mcts.getRootIndex());
 
     // Do a breadth first search through the nodes and write the Nodes and their Actions one by one.
-    while (!fringe.empty()) {
-        Node<T, A, G>* current = fringe[0];
-        fringe.erase(fringe.begin());
+    for (size_t i = 0; i < fringe.size(); i++) {
+        const Node<T, A, E>& current = mcts.getNode(fringe[i]);
 
         // Write out Node
-        dot << current->getID() << " [label=\"" << *current->getData() << "\\nVisits: " << current->getNumVisits()
-            << "\\nScore: " << current->getAvgScore() << "\"];" << endl;
+        dot << current.getID() << " [label=\"";
+        if (current.hasData())
+            dot << const_cast<T&>(current.getData()) << "\\n";
+        dot << "Visits: " << current.getNumVisits()
+            << "\\nScore: " << current.getAvgScore() << "\"];" << endl;
 
         // Write out Action as edge
-        if (current->getID() != root->getID()) {
-            dot << current->getParent()->getID() << " -> " << current->getID() << "[label=\"" << *current->getAction()
+        if (current.getParent() != NO_NODE) {
+            dot << current.getParent() << " -> " << current.getID() << "[label=\"" << const_cast<A&>(current.getAction())
                 << "\"];" << endl;
         }
 
-        vector<Node<T, A, G>*> children = current->getChildren();
-        fringe.insert(fringe.end(), children.begin(), children.end());
+        // Children that only exist as an edge have no node to write
+        for (NodeIndex child : current.getChildren()) {
+            if (child != NO_NODE)
+                fringe.push_back(child);
+        }
     }
 
     dot << "}" << endl;
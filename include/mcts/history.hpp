@@ -0,0 +1,96 @@
+#ifndef CPP_MCTS_HISTORY_HPP
+#define CPP_MCTS_HISTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief The average score of every action over all iterations it was played in
+ *
+ * Used by the progressive history heuristic, see MCTS::setActionHash(). The
+ * statistics are kept in a flat array of 2^bits entries of 8 bytes, indexed by
+ * the hash of the action. Actions whose hashes map to the same entry share
+ * their statistics, which only blurs the heuristic, so the table never grows
+ * or probes. The default of 2^12 entries takes 32 KiB.
+ */
+class HistoryTable {
+    struct Entry {
+        float scoreSum;
+        std::uint32_t visits;
+    };
+
+    std::vector<Entry> entries;
+
+    /** Shifts a 64-bit hash down to an index into entries */
+    unsigned int shift = 64;
+
+public:
+    /** The default number of bits of the index into the table */
+    static constexpr unsigned int DEFAULT_BITS = 12;
+
+    /** The largest number of bits of the index into the table */
+    static constexpr unsigned int MAX_BITS = 32;
+
+    /**
+     * @brief Remove all statistics and change the size of the table
+     * @param bits The table has 2^bits entries, between 1 and MAX_BITS
+     * @throws std::invalid_argument If bits is out of range
+     */
+    void reset(unsigned int bits)
+    {
+        checkBits(bits);
+        entries.assign(std::size_t(1) << bits, Entry { 0.0F, 0 });
+        shift = 64 - bits;
+    }
+
+    /**
+     * @return The number of bits of the index into the table, 0 before the
+     * first reset()
+     */
+    unsigned int getBits() const { return 64 - shift; }
+
+    /**
+     * @brief Add the score of an iteration the action was played in
+     *
+     * @param hash The hash of the action
+     * @param scoreSum The score, multiplied by visits
+     * @param visits The number of playouts the score stands for
+     */
+    void update(std::size_t hash, float scoreSum, int visits)
+    {
+        Entry& entry = entries[index(hash)];
+        entry.scoreSum += scoreSum;
+        entry.visits += (std::uint32_t)visits;
+    }
+
+    /**
+     * @param hash The hash of the action
+     * @return The average score of the action, 0 if it was never played
+     */
+    float getAvgScore(std::size_t hash) const
+    {
+        const Entry& entry = entries[index(hash)];
+        return entry.visits == 0 ? 0.0F : entry.scoreSum / (float)entry.visits;
+    }
+
+    /**
+     * @brief Reject a number of bits the table cannot be indexed with
+     * @throws std::invalid_argument If bits is not between 1 and MAX_BITS
+     */
+    static void checkBits(unsigned int bits)
+    {
+        if (bits < 1 || bits > MAX_BITS)
+            throw std::invalid_argument("A history table is indexed with between 1 and 32 bits");
+    }
+
+private:
+    /** Fibonacci hashing, spreads hashes that only differ in their low bits, such as small integers */
+    std::size_t index(std::size_t hash) const
+    {
+        return (std::size_t)(((std::uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+};
+
+#endif // CPP_MCTS_HISTORY_HPP
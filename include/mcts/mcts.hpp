@@ -1,15 +1,45 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__cpp_concepts) && __cpp_concepts >= 201907L
+#include <concepts>
+#define CPP_MCTS_CONCEPTS
+#endif
+
+#if defined(__cpp_lib_jthread)
+#include <stop_token>
+#define CPP_MCTS_STOP_TOKEN
+#endif
+
 #ifndef CPP_MCTS_MCTS_HPP
 #define CPP_MCTS_MCTS_HPP
 
+#include "history.hpp"
+#include "pool.hpp"
+#include "threadpool.hpp"
+#include "uct.hpp"
+
+/** Index of a Node in the ObjectPool of the MCTS instance it belongs to */
+using NodeIndex = std::uint32_t;
+
+/** NodeIndex value used when there is no Node, e.g. for the parent of the root */
+const NodeIndex NO_NODE = std::numeric_limits<NodeIndex>::max();
+
 /**
  * @brief Children of this class should represent game states
  *
@@ -49,6 +79,12 @@ public:
  *
  * <b>Action must implement a copy constructor.</b>
  *
+ * Optionally, an Action can implement
+ *
+ *     void undo(T& state);
+ *
+ * to restore the state it was executed on, see IsUndoable.
+ *
  * @tparam T The State type this Action can be executed on
  */
 template <class T>
@@ -94,6 +130,16 @@ public:
     {
     }
 
+    /**
+     * @brief Let this strategy act on another copy of its state
+     *
+     * Called by MCTS before an ExpansionStrategy is used, because the state of
+     * its Node may have been rebuilt in another place since the last use.
+     *
+     * @param newState The state to act on from now on
+     */
+    void setState(T* newState) { state = newState; }
+
     virtual ~Strategy() = default;
 };
 
@@ -102,6 +148,16 @@ public:
  *
  * This strategy generates actions that are used in the expansion stage of MCTS.
  *
+ * Implementations may also provide a member function
+ *
+ *     void generateAll(std::vector<A>& actions)
+ *
+ * which appends all actions of the state to actions at once. MCTS then adds
+ * all children of a node in its first expansion, with their statistics in one
+ * allocation, instead of adding one child per expansion and keeping the
+ * ExpansionStrategy around. Leave it out when generating all actions is
+ * expensive.
+ *
  * @note Implementing classes must have a constructor taking only one parameter
  * of type State
  *
@@ -140,6 +196,21 @@ public:
  * This strategy generates random actions that are used in the playout stage of
  * MCTS.
  *
+ * MCTS creates one PlayoutStrategy per searching thread and reuses it for all
+ * playouts of that thread. The state it acts on is overwritten with the start
+ * of every playout, which requires the State to be copy assignable.
+ * Implementations should not cache anything about the state that changes
+ * during a game.
+ *
+ * Implementations may also provide a member function
+ *
+ *     float rollout(T& state, std::mt19937& rng)
+ *
+ * which plays from state until the end of the game and returns the score
+ * Scoring would give the final state. MCTS then calls it once per playout
+ * instead of calling generateRandom(), TerminationCheck and Scoring for every
+ * move, letting the whole playout compile to a single loop.
+ *
  * @note Implementing classes must have a constructor taking only one parameter
  * of type State
  *
@@ -148,6 +219,9 @@ public:
  */
 template <class T, class A>
 class PlayoutStrategy : public Strategy<T> {
+protected:
+    /** The random generator of the thread using this strategy, set by MCTS */
+    std::mt19937* rng = nullptr;
 
 public:
     explicit PlayoutStrategy(T* state)
@@ -155,6 +229,17 @@ public:
     {
     }
 
+    /**
+     * @brief Set the random generator to use for generating actions
+     *
+     * MCTS calls this with the generator of the searching thread before the
+     * strategy is used, so implementations do not need to create and seed a
+     * generator of their own.
+     *
+     * @param newRng The generator, owned by the caller
+     */
+    void setRandomGenerator(std::mt19937* newRng) { rng = newRng; }
+
     /**
      * @brief Generate a random action
      *
@@ -244,412 +329,3294 @@ public:
 };
 
 /**
- * @brief Class used in the internal data structure of MCTS
+ * @brief Identifies states that can be reached by different sequences of actions
  *
- * A Node contains all information needed to generate children. It keeps track
- * of its score and the number of times it has been visited. Furthermore it is
- * used to generate new nodes according to the ExpansionStrategy E.
+ * When MCTS is given a StateHash (see MCTS::setTranspositions()), a state that
+ * is reached again through another sequence of actions (a transposition) is
+ * stored only once, turning the search tree into a directed acyclic graph.
  *
- * @tparam T The State type that is stored in a node
- * @tparam A The type of Action taken to get to this node
- * @tparam E The ExpansionStrategy to use when generating new nodes
+ * @tparam T The State type this StateHash can hash
  */
-template <class T, class A, class E>
-class Node {
-    unsigned int id;
-    T data;
-    std::shared_ptr<Node<T, A, E>> parent;
-    std::vector<std::shared_ptr<Node<T, A, E>>> children;
-    /** Action done to get from the parent to this node */
+template <class T>
+class StateHash {
+
+public:
+    /**
+     * @return A hash of the given state, equal states must have equal hashes
+     */
+    virtual std::size_t hash(const T& state) = 0;
+
+    /**
+     * @return True if both states represent the same position in the game
+     */
+    virtual bool equals(const T& a, const T& b) = 0;
+
+    virtual ~StateHash() = default;
+};
+
+/**
+ * @brief Hashes actions for the progressive history and RAVE heuristics
+ *
+ * When MCTS is given an ActionHash (see MCTS::setActionHash()), it keeps the
+ * average score of every action over all positions it was played in, and
+ * favours actions with a high average during selection. RAVE (see
+ * MCTS::setRave()) compares the hashes of the actions played in an iteration
+ * with the actions of the children of every node on its path. In games where
+ * the same action can be played by several players, the hash should include
+ * the player.
+ *
+ * @tparam A The Action type this ActionHash can hash
+ */
+template <class A>
+class ActionHash {
+
+public:
+    /**
+     * @return A hash of the given action, equal actions must have equal hashes
+     */
+    virtual std::size_t hash(const A& action) = 0;
+
+    virtual ~ActionHash() = default;
+};
+
+/**
+ * @brief The statistics of one of the actions available at the root of a search
+ *
+ * @tparam A The Action type
+ */
+template <class A>
+struct ActionStatistics {
     A action;
-    E expansion;
-    int numVisits = 0;
-    float scoreSum = 0.0F;
+    int numVisits;
+    float scoreSum;
+};
+
+/**
+ * @brief The progress of a search started by MCTS::calculateActionAsync()
+ *
+ * The search publishes the statistics of the root every few iterations, at
+ * most MCTS::setTimeSlack() apart, and reads the stop request every iteration.
+ * Shared by the search and its AsyncSearch.
+ *
+ * @tparam A The Action type
+ */
+template <class A>
+class SearchProgress {
+    /** Guards everything but stopRequested */
+    mutable std::mutex mutex;
+    std::vector<ActionStatistics<A>> statistics;
+    A bestAction;
+    unsigned int iterations = 0;
+    std::atomic<bool> stopRequested { false };
 
 public:
     /**
-     * @brief Create a new node in the search tree
+     * @param action The action chosen when the search ends before the root is expanded
+     */
+    explicit SearchProgress(A action)
+        : bestAction(std::move(action))
+    {
+    }
+
+    /**
+     * @brief Replace the published statistics
      *
-     * This constructor initializes the nodes and creates a new instance of the
-     * ExpansionStrategy passed as template parameter E.
+     * The action with the best average score becomes the best action. When no
+     * action was visited yet, the previous best action is kept.
      *
-     * @param id An identifier unique to the tree this node is in
-     * @param data The state stored in this node
-     * @param parent The parent node
-     * @param action The action taken to get to this node from the parent node
+     * @param rootStatistics The statistics of every action at the root
+     * @param numIterations The number of iterations done so far
      */
-    Node(unsigned int id, T data, std::shared_ptr<Node<T, A, E>> parent, A action)
-        : id(id)
-        , data(std::move(data))
-        , parent(parent)
-        , action(std::move(action))
-        , expansion(&this->data)
+    void publish(std::vector<ActionStatistics<A>> rootStatistics, unsigned int numIterations)
+    {
+        const ActionStatistics<A>* best = nullptr;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (const auto& entry : rootStatistics) {
+            float score = entry.scoreSum / entry.numVisits;
+            if (score > bestScore) {
+                bestScore = score;
+                best = &entry;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (best)
+            bestAction = best->action;
+        statistics = std::move(rootStatistics);
+        iterations = numIterations;
+    }
+
+    /** @return The best action published last */
+    A getBestAction() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bestAction;
+    }
+
+    /** @return The root statistics published last */
+    std::vector<ActionStatistics<A>> getRootStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statistics;
+    }
+
+    /** @return The number of iterations published last */
+    unsigned int getIterations() const
     {
+        std::lock_guard<std::mutex> lock(mutex);
+        return iterations;
     }
 
+    /** @brief Make the search end after its current iteration */
+    void requestStop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+    /** @return True if requestStop() was called */
+    bool isStopRequested() const { return stopRequested.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Handle of a search running in the background, see MCTS::calculateActionAsync()
+ *
+ * The best action and root statistics found so far can be read at any time
+ * while the search continues. They lag behind the search by at most the time
+ * slack of the MCTS instance.
+ *
+ * Destroying the handle stops the search and waits until it has ended, so
+ * the MCTS instance can be used again once its handle is gone.
+ *
+ * @tparam A The Action type
+ */
+template <class A>
+class AsyncSearch {
+    std::shared_ptr<SearchProgress<A>> progress;
+    std::future<A> result;
+
+#if defined(CPP_MCTS_STOP_TOKEN)
+    struct RequestStop {
+        SearchProgress<A>* progress;
+        void operator()() const noexcept { progress->requestStop(); }
+    };
+
+    /** Forwards the stop token passed to stopOn() */
+    std::unique_ptr<std::stop_callback<RequestStop>> stopCallback;
+#endif
+
+public:
+    /** Create a handle without a search, valid() returns false */
+    AsyncSearch() = default;
+
     /**
-     * @return The unique ID of this node
+     * @param progress Shared with the search
+     * @param result Becomes ready with the chosen action when the search ends
      */
-    unsigned int getID() const { return id; }
+    AsyncSearch(std::shared_ptr<SearchProgress<A>> progress, std::future<A> result)
+        : progress(std::move(progress))
+        , result(std::move(result))
+    {
+    }
+
+    AsyncSearch(AsyncSearch&& other) noexcept = default;
+
+    AsyncSearch& operator=(AsyncSearch&& other) noexcept
+    {
+        stop();
+        progress = std::move(other.progress);
+        result = std::move(other.result);
+#if defined(CPP_MCTS_STOP_TOKEN)
+        stopCallback = std::move(other.stopCallback);
+#endif
+        return *this;
+    }
+
+    ~AsyncSearch() { stop(); }
 
     /**
-     * @return The State associated with this Node
+     * @return True if this handle refers to a search whose action was not
+     * retrieved with get() yet
      */
-    const T& getData() const { return data; }
+    bool valid() const { return result.valid(); }
 
     /**
-     * @return This Node's parent or nullptr if no parent exists (this Node is the
-     * root)
+     * @return The action with the best average score at the root so far. Once
+     * the search has ended, the action it chose.
      */
-    std::shared_ptr<Node<T, A, E>> getParent() const { return parent; }
+    A getBestAction() const { return progress->getBestAction(); }
 
     /**
-     * @return All children of this Node
+     * @return The visits and score sums of the actions at the root so far
      */
-    const std::vector<std::shared_ptr<Node<T, A, E>>>& getChildren() const { return children; }
+    std::vector<ActionStatistics<A>> getRootStatistics() const { return progress->getRootStatistics(); }
 
     /**
-     * @return The Action to execute on the parent's State to get from the
-     * parent's State to this Node's State.
+     * @return The number of iterations done so far
      */
-    const A& getAction() const { return action; }
+    unsigned int getIterations() const { return progress->getIterations(); }
 
     /**
-     * @return A new action if there are any remaining, nullptr if not
+     * @brief End the search after its current iteration, even when fewer than
+     * the minimum number of iterations were done
+     *
+     * Does not wait for the search to end.
      */
-    A generateNextAction() { return expansion.generateNext(); }
+    void requestStop() { progress->requestStop(); }
 
     /**
-     * @brief Add a child to this Node's children
-     * @param child The child to add
+     * @return True if requestStop() was called or the stop token was stopped
      */
-    void addChild(const std::shared_ptr<Node<T, A, E>>& child) { children.push_back(child); }
+    bool isStopRequested() const { return progress->isStopRequested(); }
 
+#if defined(CPP_MCTS_STOP_TOKEN)
     /**
-     * @brief Checks this Node's ActionGenerator if there are more Actions to be
-     * generated.
-     * @return True if it is still possible to add children
+     * @brief Stop the search when a stop is requested through the given token
      */
-    bool shouldExpand() const
+    void stopOn(std::stop_token stopToken)
     {
-        return children.empty() || expansion.canGenerateNext();
+        stopCallback.reset(new std::stop_callback<RequestStop>(std::move(stopToken), RequestStop { progress.get() }));
     }
+#endif
 
     /**
-     * @brief Update this Node's score and increment the number of visits.
-     * @param score
+     * @return True if the search has ended
+     */
+    bool isDone() const { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    /**
+     * @brief Wait until the search has ended or the timeout has passed
+     *
+     * @param timeout The longest time to wait
+     * @return True if the search has ended
      */
-    void update(float score)
+    template <class Rep, class Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const
     {
-        this->scoreSum += score;
-        numVisits++;
+        return result.wait_for(timeout) == std::future_status::ready;
     }
 
     /**
-     * @return The total score divided by the number of visits.
+     * @brief Wait until the search has ended
      */
-    float getAvgScore() const { return scoreSum / numVisits; }
+    void wait() const { result.wait(); }
 
     /**
-     * @return The number of times updateScore(score) was called
+     * @brief Wait until the search has ended and take its action
+     *
+     * Rethrows the exception thrown by the search, if any. Afterwards valid()
+     * returns false.
+     *
+     * @return The action chosen by the search
      */
-    int getNumVisits() const { return numVisits; }
+    A get() { return result.get(); }
+
+private:
+    void stop()
+    {
+        if (result.valid()) {
+            progress->requestStop();
+            result.wait();
+        }
+    }
 };
 
 /**
- * @brief AI search technique for finding the best Action give a certain State
+ * @brief What MCTS does when the tree reaches the size set by MCTS::setMaxNodes()
+ */
+enum class MemoryLimitPolicy {
+    /** Keep searching without adding nodes, playouts start at the selected node */
+    STOP_EXPANDING,
+    /** Remove the subtrees below the nodes with the fewest visits */
+    EVICT_LEAST_VISITED,
+    /** Remove the subtrees below the nodes that were visited longest ago */
+    EVICT_LEAST_RECENT
+};
+
+/**
+ * @brief Which nodes keep a copy of their state, see MCTS::setStateStorage()
+ */
+enum class StateStorage {
+    /** Every node stores its state */
+    FULL,
+    /** Only the root stores its state, other states are rebuilt by replaying actions from the root */
+    REPLAY,
+    /** Nodes every k levels below the root store their state, other states are rebuilt from the closest of those */
+    CHECKPOINT
+};
+
+/**
+ * @brief Statistics used in selection when a node can be reached from several parents
+ */
+enum class TranspositionBackup {
+    /** Use the statistics of the edge from the parent, counting only playouts through that parent */
+    EDGE,
+    /** Use the average score of the shared child, counting playouts through all of its parents */
+    NODE
+};
+
+/**
+ * @brief Detects Actions that can be undone
  *
- * The MCTS algorithm has four stages: selection, expansion, playout and
- * backpropagation. This class represents the general framework for executing
- * these stages and uses a number of user-implemented classes which implement
- * the game rules.
+ * An Action implementing
  *
- * In the selection stage, MCTS uses the UCT formula to select the best node (or
- * randomly if a node has not been visited often enough, see
- * MCTS::setMinVisits()) until it finds a node that still has nodes left to be
- * expanded. The UCT formula has one parameter, see MCTS::setC(). When PROG_HIST
- * is defined, the progressive history heuristic is used to influence the
- * selection based on the success of an action during the playout stage.
- * MCTS::setW() is used to set the W parameter for progressive history.
+ *     void undo(T& state);
  *
- * In the expansion stage an action is requested from the ExpansionStrategy and
- * a node is expanded using that action. When a node is not visited at least T
- * times, expansion is skipped (see MCTS::setMinT()).
+ * restores the state to what it was before execute() was called. undo() is
+ * called on the same object that executed the action, so execute() may store
+ * what undo() needs, such as a captured piece.
  *
- * In the playout stage, the PlayoutStrategy is used to generate moves until the
- * end of the game is reached. When a terminal state (the end of the game) is
- * encoutered, the score is calculated using Scoring.
+ * For such Actions, MCTS keeps one working state per thread instead of copying
+ * states. Every iteration executes the actions on the path from the root and
+ * the playout on the working state, then undoes them in reverse order while
+ * backpropagating.
  *
- * In the backpropagation stage, Node::update() is called for each node from the
- * node expanded in the expansion stage to the root node. The score passed to
- * Node::update() is the one from the call to Scoring::score() passed to
- * Backpropagation::updateScore() for each call to Node::update().
+ * @tparam A The Action type
+ * @tparam T The State type
+ */
+template <class A, class T, class = void>
+struct IsUndoable : std::false_type {
+};
+
+template <class A, class T>
+struct IsUndoable<A, T, decltype(void(std::declval<A&>().undo(std::declval<T&>())))> : std::true_type {
+};
+
+/**
+ * @brief Calls an ExpansionStrategy, which either keeps a pointer to the state
+ * of its Node or is passed that state on every call
  *
- * The time that MCTS is allowed to search van be set by MCTS::setTime().
+ * An ExpansionStrategy deriving from ExpansionStrategy is constructed with a
+ * pointer to the state of its Node. A stateless ExpansionStrategy does not have
+ * to derive from any class. It is constructed from the state and receives the
+ * state in every call:
  *
- * @tparam T The State type this MCTS operates on
- * @tparam A The Action type this MCTS operates on
- * @tparam E The ExpansionStrategy this MCTS uses
- * @tparam P The PlayoutStrategy this MCTS uses
+ *     explicit E(const T& state);
+ *     A generateNext(const T& state);
+ *     bool canGenerateNext(const T& state) const;
+ *
+ * and optionally
+ *
+ *     void generateAll(const T& state, std::vector<A>& actions);
+ *
+ * Together with State and Action types without virtual functions, this keeps
+ * vtable pointers and the state pointer out of every Node.
+ *
+ * @tparam E The ExpansionStrategy type
+ * @tparam T The State type
+ * @tparam A The Action type
  */
-template <class T, class A, class E, class P>
-class MCTS {
-    /** Default thinking time in milliseconds */
-    const int DEFAULT_TIME = 500;
+template <class E, class T, class A, class = void>
+struct ExpansionAccess {
+    static E create(T& state) { return E(&state); }
 
-    /** MCTS can go over time if it has less than this amount of iterations */
-    const int DEFAULT_MIN_ITERATIONS = 0;
+    static void setState(E& expansion, T& state) { expansion.setState(&state); }
 
-    /** Default C for the UCT formula */
-    static constexpr float DEFAULT_C = 0.5;
+    static A generateNext(E& expansion, const T& /* state */) { return expansion.generateNext(); }
 
-    /** Minimum number of visits until a Node will be expanded */
-    const int DEFAULT_MIN_T = 5;
+    static bool canGenerateNext(const E& expansion, const T& /* state */) { return expansion.canGenerateNext(); }
 
-    /** Default number of visits until a node can be selected using UCT instead of
-     * randomly */
-    const int DEFAULT_MIN_VISITS = 5;
+    /** Append all actions of state to actions, chosen when E implements generateAll() */
+    template <class F = E>
+    static auto generateAll(T& state, std::vector<A>& actions, int) -> decltype(std::declval<F&>().generateAll(actions), true)
+    {
+        F expansion(&state);
+        expansion.generateAll(actions);
+        return true;
+    }
+
+    /** @return False, E generates one action at a time */
+    static bool generateAll(T& /* state */, std::vector<A>& /* actions */, long) { return false; }
+};
 
-    Backpropagation<T>* backprop;
-    TerminationCheck<T>* termination;
-    Scoring<T>* scoring;
+/**
+ * @brief Calls a stateless ExpansionStrategy
+ * @see ExpansionAccess
+ */
+template <class E, class T, class A>
+struct ExpansionAccess<E, T, A, decltype(void(std::declval<const E&>().canGenerateNext(std::declval<const T&>())))> {
+    static E create(T& state) { return E(static_cast<const T&>(state)); }
 
-    std::shared_ptr<Node<T, A, E>> root;
+    static void setState(E& /* expansion */, T& /* state */) { }
 
-    /** The time MCTS is allowed to search */
-    std::chrono::milliseconds allowedComputationTime = std::chrono::milliseconds(DEFAULT_TIME);
+    static A generateNext(E& expansion, const T& state) { return expansion.generateNext(state); }
 
-    /** MCTS can go over time if it has less than this amount of iterations */
-    int minIterations = DEFAULT_MIN_ITERATIONS;
+    static bool canGenerateNext(const E& expansion, const T& state) { return expansion.canGenerateNext(state); }
 
-    /** Tunable bias parameter for node selection */
-    float C = DEFAULT_C;
+    template <class F = E>
+    static auto generateAll(T& state, std::vector<A>& actions, int) -> decltype(std::declval<F&>().generateAll(static_cast<const T&>(state), actions), true)
+    {
+        F expansion(static_cast<const T&>(state));
+        expansion.generateAll(static_cast<const T&>(state), actions);
+        return true;
+    }
 
-    /** Minimum number of visits until a Node will be expanded */
-    int minT = DEFAULT_MIN_T;
+    static bool generateAll(T& /* state */, std::vector<A>& /* actions */, long) { return false; }
+};
 
-    /** Minimum number of visits until a Node will be selected using the UCT
-     * formula, below this number random selection is used */
-    int minVisits = DEFAULT_MIN_VISITS;
+#if defined(CPP_MCTS_CONCEPTS)
+/**
+ * @brief A game state that MCTS can store in nodes and copy into playouts
+ *
+ * Deriving from State is not required.
+ */
+template <class T>
+concept GameState = std::copy_constructible<T> && std::is_copy_assignable_v<T>;
+
+/**
+ * @brief An action that can be executed on a T
+ *
+ * Deriving from Action is not required.
+ */
+template <class A, class T>
+concept GameAction = std::default_initializable<A> && std::copy_constructible<A> && requires(A& action, T& state) {
+    action.execute(state);
+};
 
-    /** Variable to assign IDs to a node */
-    unsigned int currentNodeID = 0;
+/**
+ * @brief Either an ExpansionStrategy keeping a pointer to its state or a
+ * stateless ExpansionStrategy, see ExpansionAccess
+ */
+template <class E, class T, class A>
+concept GameExpansionStrategy = std::move_constructible<E>
+    && ((std::constructible_from<E, T*> && requires(E& expansion, const E& constExpansion, T* state) {
+           { expansion.generateNext() } -> std::convertible_to<A>;
+           { constExpansion.canGenerateNext() } -> std::convertible_to<bool>;
+           expansion.setState(state);
+       })
+        || (std::constructible_from<E, const T&> && requires(E& expansion, const E& constExpansion, const T& state) {
+               { expansion.generateNext(state) } -> std::convertible_to<A>;
+               { constExpansion.canGenerateNext(state) } -> std::convertible_to<bool>;
+           }));
 
-    /** The number of search iterations so far */
-    unsigned int iterations = 0;
+/**
+ * @brief A PlayoutStrategy acting on a T, see PlayoutStrategy for the optional
+ * rollout() and setRandomGenerator() functions
+ */
+template <class P, class T, class A>
+concept GamePlayoutStrategy = std::constructible_from<P, T*> && requires(P& playout, A& action) {
+    playout.generateRandom(action);
+};
+
+/** @brief A Backpropagation for states of type T */
+template <class B, class T>
+concept GameBackpropagation = requires(B& backprop, const T& state, float score) {
+    { backprop.updateScore(state, score) } -> std::convertible_to<float>;
+};
+
+/** @brief A TerminationCheck for states of type T */
+template <class TC, class T>
+concept GameTerminationCheck = requires(TC& termination, const T& state) {
+    { termination.isTerminal(state) } -> std::convertible_to<bool>;
+};
+
+/** @brief A Scoring for states of type T */
+template <class S, class T>
+concept GameScoring = requires(S& scoring, const T& state) {
+    { scoring.score(state) } -> std::convertible_to<float>;
+};
+#endif
 
-    /** Random generator used in node selection */
-    std::mt19937 generator;
+/**
+ * @brief Owns one of the Backpropagation, TerminationCheck or Scoring policies
+ * of MCTS
+ *
+ * A concrete policy type is stored by value, so the compiler knows the exact
+ * type of the policy and can inline its calls. An abstract policy type, such as
+ * Scoring<T> itself, is stored through a pointer and called virtually.
+ *
+ * Both can be created from a pointer allocated with new, which is deleted by
+ * the holder. A concrete policy passed as pointer must have exactly type
+ * Policy, it is moved into the holder.
+ *
+ * @tparam Policy The policy type
+ */
+template <class Policy, bool Virtual = std::is_abstract<Policy>::value>
+class PolicyHolder {
+    Policy policy;
 
 public:
-    /**
-     * @note backprop, termination and scoring will be deleted by this MCTS
-     * instance
-     */
-    MCTS(const T& rootData, Backpropagation<T>* backprop, TerminationCheck<T>* termination, Scoring<T>* scoring)
-        : backprop(backprop)
-        , termination(termination)
-        , scoring(scoring)
-        , root(std::make_shared<Node<T, A, E>>(0, rootData, nullptr, A()))
+    /** Take ownership of the given policy */
+    PolicyHolder(Policy* owned)
+        : policy(std::move(*owned))
+    {
+        delete owned;
+    }
+
+    /** Store a copy of the given policy */
+    PolicyHolder(Policy value)
+        : policy(std::move(value))
     {
     }
 
-    MCTS(const MCTS& other) = default;
-    MCTS(MCTS&& other)
-    noexcept = default;
+    Policy* operator->() { return &policy; }
+};
 
-    MCTS<T, A, E, P>& operator=(const MCTS<T, A, E, P>& other) = default;
-    MCTS<T, A, E, P>& operator=(MCTS<T, A, E, P>&& other) noexcept = default;
+/**
+ * @brief Holds an abstract policy through a pointer
+ * @see PolicyHolder
+ */
+template <class Policy>
+class PolicyHolder<Policy, true> {
+    std::unique_ptr<Policy> policy;
 
-    /**
-     * @brief Runs the MCTS algorithm and searches for the best Action
-     *
-     * @return The Action found by MCTS
-     */
-    A calculateAction()
+public:
+    /** Take ownership of the given policy */
+    PolicyHolder(Policy* owned)
+        : policy(owned)
     {
-        search();
+    }
 
-        // Select the Action with the best score
-        std::shared_ptr<Node<T, A, E>> best;
-        float bestScore = -std::numeric_limits<float>::max();
-        auto& children = root->getChildren();
+    Policy* operator->() { return policy.get(); }
+};
 
-        for (unsigned int i = 0; i < children.size(); i++) {
-            float score = children[i]->getAvgScore();
-            if (score > bestScore) {
+/**
+ * @brief Class used in the internal data structure of MCTS
+ *
+ * A Node contains all information needed to generate children. It keeps track
+ * of its score and the number of times it has been visited. Furthermore it is
+ * used to generate new nodes according to the ExpansionStrategy E.
+ *
+ * The ExpansionStrategy of a Node is only created when the Node is expanded
+ * for the first time and released as soon as it has generated all actions.
+ * MCTS keeps it in a separate pool, the Node only stores its index there (see
+ * getExpansion()). Leaves that are never expanded do not pay for one.
+ *
+ * The state of a Node is owned by its MCTS instance as well. Depending on the
+ * StateStorage, only some nodes store their state (see hasData()), the states
+ * of the others are rebuilt by MCTS when needed.
+ *
+ * The visit counts and score sums of a Node's children are also kept in the
+ * Node itself, in arrays parallel to getChildren(), so selection can score all
+ * children without touching the child nodes. The statistics only some
+ * searches keep, for RAVE and the MCTS-Solver, are allocated on first use.
+ *
+ * Nodes are owned by the ObjectPool of the MCTS instance that created them.
+ * Parent and child links are the 32-bit indices of those nodes in that pool.
+ *
+ * The visit count and score sum of a Node are atomic so several threads can
+ * update them at once. The children, their statistics and the
+ * ExpansionStrategy are guarded by lock() and unlock() when several threads
+ * search the same tree.
+ *
+ * @tparam T The State type that is stored in a node
+ * @tparam A The type of Action taken to get to this node
+ * @tparam E The ExpansionStrategy to use when generating new nodes
+ */
+template <class T, class A, class E>
+class Node {
+    NodeIndex id;
+    NodeIndex parent;
+    /** The state of this node, nullptr if it is not stored */
+    T* data;
+    std::vector<NodeIndex> children;
+    /** Actions leading to the children, parallel to children once storeChildActions() is called */
+    std::vector<A> childActions;
+    /** Number of visits of each child, parallel to children */
+    std::vector<int> childVisits;
+    /** Sum of the scores of each child, parallel to children */
+    std::vector<float> childScoreSums;
+
+    /** Data about the children that only some searches keep */
+    struct ChildExtras {
+        /** All-moves-as-first visits of each child, parallel to children once the first is counted */
+        std::vector<int> amafVisits;
+        /** Sum of the all-moves-as-first scores of each child, parallel to amafVisits */
+        std::vector<float> amafScoreSums;
+        /** Hash of the action of each child, parallel to children once the first is hashed */
+        std::vector<std::size_t> actionHashes;
+        /** Proven score of each child for the player choosing at this node, NaN if unknown, parallel to children
+         * once the first child is solved */
+        std::vector<float> solvedScores;
+        /** Proven result of each child, parallel to solvedScores */
+        std::vector<float> solvedResults;
+    };
+
+    /** Allocated on first use, so searches that do not need it pay only for the pointer */
+    std::unique_ptr<ChildExtras> extras;
+    /** Action done to get from the parent to this node */
+    A action;
+    /** Index of the ExpansionStrategy in the pool of the MCTS instance, or NOT_EXPANDED or FULLY_EXPANDED */
+    std::uint32_t expansion = NOT_EXPANDED;
+    std::atomic<int> numVisits { 0 };
+    std::atomic<float> scoreSum { 0.0F };
+    /** The result of Scoring::score() reached from this node with perfect play, NaN until proven */
+    std::atomic<float> solvedResult { std::numeric_limits<float>::quiet_NaN() };
+    /** Value of the MCTS visit clock when this node was last updated */
+    std::uint32_t lastVisit = 0;
+    /** Set between generating the last action of this node and adding its child */
+    bool addingLastChild = false;
+    /** Set once childActions holds the action of every child, see storeChildActions() */
+    bool childActionsStored = false;
+    /** Set while a thread holds the lock of this node */
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+public:
+    /** Value of getExpansion() before the first expansion */
+    static constexpr std::uint32_t NOT_EXPANDED = std::numeric_limits<std::uint32_t>::max();
+
+    /** Value of getExpansion() once all actions have been generated */
+    static constexpr std::uint32_t FULLY_EXPANDED = NOT_EXPANDED - 1;
+
+    /**
+     * @brief Create a new node in the search tree
+     *
+     * The ExpansionStrategy is not created until the first expansion, see
+     * setExpansion().
+     *
+     * @param id The index of this node in the ObjectPool it is stored in
+     * @param data The state of this node, owned by the caller, or nullptr if
+     * the state is not stored
+     * @param parent The index of the parent node, NO_NODE for the root
+     * @param action The action taken to get to this node from the parent node
+     */
+    Node(NodeIndex id, T* data, NodeIndex parent, A action)
+        : id(id)
+        , parent(parent)
+        , data(data)
+        , action(std::move(action))
+    {
+    }
+
+    /**
+     * @brief Move a node to a new position in the tree
+     *
+     * @param other The node to move
+     * @param id The new index of this node
+     * @param parent The new index of the parent node, NO_NODE for the root
+     * @param newIndices The new index of every node, indexed by old index
+     */
+    Node(Node<T, A, E>&& other, NodeIndex id, NodeIndex parent, const std::vector<NodeIndex>& newIndices)
+        : id(id)
+        , parent(parent)
+        , data(other.data)
+        , children(std::move(other.children))
+        , childActions(std::move(other.childActions))
+        , childVisits(std::move(other.childVisits))
+        , childScoreSums(std::move(other.childScoreSums))
+        , extras(std::move(other.extras))
+        , action(std::move(other.action))
+        , expansion(other.expansion)
+        , numVisits(other.numVisits.load(std::memory_order_relaxed))
+        , scoreSum(other.scoreSum.load(std::memory_order_relaxed))
+        , solvedResult(other.solvedResult.load(std::memory_order_relaxed))
+        , lastVisit(other.lastVisit)
+        , addingLastChild(other.addingLastChild)
+        , childActionsStored(other.childActionsStored)
+    {
+        for (NodeIndex& child : children) {
+            if (child != NO_NODE)
+                child = newIndices[child];
+        }
+    }
+
+    /**
+     * @return The unique ID of this node, which is its index in the tree
+     */
+    NodeIndex getID() const { return id; }
+
+    /**
+     * @return The State associated with this Node, only available if
+     * hasData() is true
+     */
+    const T& getData() const { return *data; }
+
+    /**
+     * @return True if this Node stores its state, otherwise getData() must not
+     * be called
+     */
+    bool hasData() const { return data != nullptr; }
+
+    /**
+     * @return The stored state of this Node, nullptr if it is not stored
+     */
+    T* getStoredData() const { return data; }
+
+    /**
+     * @param newData The state of this Node, owned by the caller
+     */
+    void setData(T* newData) { data = newData; }
+
+    /**
+     * @return The index of this Node's parent or NO_NODE if no parent exists
+     * (this Node is the root). With transpositions, this is the parent the node
+     * was first reached from.
+     */
+    NodeIndex getParent() const { return parent; }
+
+    /**
+     * @return The indices of all children of this Node, NO_NODE for children
+     * that only exist as an edge, see addEdge()
+     */
+    const std::vector<NodeIndex>& getChildren() const { return children; }
+
+    /**
+     * @return The number of visits of every child, in the order of getChildren()
+     */
+    const std::vector<int>& getChildVisits() const { return childVisits; }
+
+    /**
+     * @return The sum of the scores of every child, in the order of getChildren()
+     */
+    const std::vector<float>& getChildScoreSums() const { return childScoreSums; }
+
+    /**
+     * @return The number of all-moves-as-first visits of every child, in the
+     * order of getChildren(). Shorter than getChildren() when the last
+     * children were never counted, see updateChildAmaf().
+     */
+    const std::vector<int>& getChildAmafVisits() const { return getExtras().amafVisits; }
+
+    /**
+     * @return The sum of the all-moves-as-first scores of every child, as long
+     * as getChildAmafVisits()
+     */
+    const std::vector<float>& getChildAmafScoreSums() const { return getExtras().amafScoreSums; }
+
+    /**
+     * @return The hash of the action of every child, in the order of
+     * getChildren(). Shorter than getChildren() when the last children were
+     * not hashed yet, see addChildActionHash().
+     */
+    const std::vector<std::size_t>& getChildActionHashes() const { return getExtras().actionHashes; }
+
+    /**
+     * @brief Remember the hash of the action of the next child that has none
+     * @param hash The hash of the action of child getChildActionHashes().size()
+     */
+    void addChildActionHash(std::size_t hash) { allocateExtras().actionHashes.push_back(hash); }
+
+    /**
+     * @return The Action to execute on the parent's State to get from the
+     * parent's State to this Node's State. With transpositions, this is the
+     * action from the parent the node was first reached from, the action from
+     * every parent is kept by that parent, see getChildAction().
+     */
+    const A& getAction() const { return action; }
+
+    /**
+     * @return The index of the ExpansionStrategy of this Node in the pool of
+     * its MCTS instance, NOT_EXPANDED or FULLY_EXPANDED
+     */
+    std::uint32_t getExpansion() const { return expansion; }
+
+    /**
+     * @param newExpansion The index of the ExpansionStrategy of this Node,
+     * NOT_EXPANDED or FULLY_EXPANDED
+     */
+    void setExpansion(std::uint32_t newExpansion) { expansion = newExpansion; }
+
+    /**
+     * @return True if this Node has an ExpansionStrategy in the pool of its
+     * MCTS instance
+     */
+    bool hasExpansion() const { return expansion < FULLY_EXPANDED; }
+
+    /**
+     * @brief Add a child to this Node's children
+     * @param child The index of the child to add
+     * @param childAction The action leading to the child, only kept if
+     * hasChildActions() is true
+     */
+    void addChild(NodeIndex child, const A& childAction)
+    {
+        children.push_back(child);
+        childVisits.push_back(0);
+        childScoreSums.push_back(0.0F);
+        if (childActionsStored)
+            childActions.push_back(childAction);
+    }
+
+    /**
+     * @brief Keep the action leading to every child in this Node from now on
+     *
+     * Until this is called, the node of every child holds the action leading
+     * to it. Children whose node does not, edges and nodes shared with other
+     * parents, can only be added afterwards.
+     *
+     * @param pool The pool holding the children of this Node
+     */
+    void storeChildActions(const ObjectPool<Node<T, A, E>>& pool)
+    {
+        if (childActionsStored)
+            return;
+        childActions.reserve(children.capacity());
+        for (NodeIndex child : children)
+            childActions.push_back(pool[child].getAction());
+        childActionsStored = true;
+    }
+
+    /**
+     * @return True if this Node keeps the action leading to every child, see
+     * storeChildActions()
+     */
+    bool hasChildActions() const { return childActionsStored; }
+
+    /**
+     * @param slot The position of a child in getChildren()
+     * @return The action leading to that child, only available if
+     * hasChildActions() is true
+     */
+    const A& getChildAction(std::size_t slot) const { return childActions[slot]; }
+
+    /**
+     * @brief Add a child whose node does not hold the action leading to it
+     * from this Node, e.g. a node shared with another parent
+     *
+     * storeChildActions() must have been called.
+     *
+     * @param child The index of the child to add, NO_NODE for an edge
+     * @param childAction The action leading to the child
+     */
+    void addSharedChild(NodeIndex child, A childAction)
+    {
+        childActions.push_back(std::move(childAction));
+        children.push_back(child);
+        childVisits.push_back(0);
+        childScoreSums.push_back(0.0F);
+    }
+
+    /**
+     * @brief Allocate room for the given number of children at once
+     * @param n The number of children
+     * @param asEdges True if the children will be added with addEdge()
+     */
+    void reserveChildren(std::size_t n, bool asEdges)
+    {
+        children.reserve(n);
+        childVisits.reserve(n);
+        childScoreSums.reserve(n);
+        if (asEdges)
+            childActions.reserve(n);
+    }
+
+    /**
+     * @brief Add a child that only exists as an action and statistics, without
+     * a node and a state
+     *
+     * Its position in getChildren() holds NO_NODE until setChild() is called.
+     * storeChildActions() must have been called.
+     *
+     * @param edgeAction The action leading to the child
+     */
+    void addEdge(A edgeAction) { addSharedChild(NO_NODE, std::move(edgeAction)); }
+
+    /**
+     * @brief Give a child added by addEdge() its node
+     * @param slot The position of the child in getChildren()
+     * @param child The index of the node of the child
+     */
+    void setChild(std::size_t slot, NodeIndex child) { children[slot] = child; }
+
+    /**
+     * @brief Replace the score sum of a child, keeping its number of visits
+     * @param slot The position of the child in getChildren()
+     * @param avgScore The new average score of the child
+     */
+    void setChildAvgScore(std::size_t slot, float avgScore) { childScoreSums[slot] = avgScore * childVisits[slot]; }
+
+    /**
+     * @brief Update the statistics this Node keeps for one of its children
+     * @param slot The position of the child in getChildren()
+     * @param score The score to add to the child's score sum
+     * @param virtualLoss The virtual loss added by addChildVirtualLoss() to remove
+     * @param visits The number of visits the score was summed over
+     */
+    void updateChild(std::size_t slot, float score, int virtualLoss = 0, int visits = 1)
+    {
+        childScoreSums[slot] += score;
+        childVisits[slot] += visits - virtualLoss;
+    }
+
+    /**
+     * @brief Count visits without a score for one of the children, making it
+     * less attractive to other threads until updateChild() removes them
+     * @param slot The position of the child in getChildren()
+     * @param virtualLoss The number of visits to add
+     */
+    void addChildVirtualLoss(std::size_t slot, int virtualLoss) { childVisits[slot] += virtualLoss; }
+
+    /**
+     * @brief Count an iteration in which the action of one of the children was
+     * played later on, for RAVE
+     * @param slot The position of the child in getChildren()
+     * @param score The score to add to the child's all-moves-as-first score sum
+     * @param visits The number of visits the score was summed over
+     */
+    void updateChildAmaf(std::size_t slot, float score, int visits = 1)
+    {
+        // Nodes of searches without RAVE never allocate the arrays
+        ChildExtras& amaf = allocateExtras();
+        if (amaf.amafVisits.size() <= slot) {
+            amaf.amafVisits.resize(children.size(), 0);
+            amaf.amafScoreSums.resize(children.size(), 0.0F);
+        }
+        amaf.amafScoreSums[slot] += score;
+        amaf.amafVisits[slot] += visits;
+    }
+
+    /**
+     * @brief Record the proven outcome of one of the children, for the MCTS-Solver
+     * @param slot The position of the child in getChildren()
+     * @param score The proven score of the child for the player choosing at this node
+     * @param result The proven result of Scoring::score() the child leads to
+     */
+    void setChildSolved(std::size_t slot, float score, float result)
+    {
+        // Nodes of searches without the MCTS-Solver never allocate the arrays
+        ChildExtras& solved = allocateExtras();
+        if (solved.solvedScores.size() <= slot) {
+            solved.solvedScores.resize(children.size(), std::numeric_limits<float>::quiet_NaN());
+            solved.solvedResults.resize(children.size(), std::numeric_limits<float>::quiet_NaN());
+        }
+        solved.solvedScores[slot] = score;
+        solved.solvedResults[slot] = result;
+    }
+
+    /**
+     * @return The proven score of every child for the player choosing at this
+     * node, NaN for children that are not solved. Shorter than getChildren()
+     * when the last children are not solved, see setChildSolved().
+     */
+    const std::vector<float>& getChildSolvedScores() const { return getExtras().solvedScores; }
+
+    /**
+     * @return The proven result of Scoring::score() every child leads to, as
+     * long as getChildSolvedScores()
+     */
+    const std::vector<float>& getChildSolvedResults() const { return getExtras().solvedResults; }
+
+    /**
+     * @param slot The position of a child in getChildren()
+     * @return True if the outcome of the child is proven
+     */
+    bool isChildSolved(std::size_t slot) const
+    {
+        const std::vector<float>& scores = getChildSolvedScores();
+        return slot < scores.size() && !std::isnan(scores[slot]);
+    }
+
+    /**
+     * @return True if the outcome of at least one child is proven
+     */
+    bool hasSolvedChildren() const { return !getChildSolvedScores().empty(); }
+
+    /**
+     * @brief Mark that the last action of this Node was generated, but its
+     * child is not added yet
+     * @param adding False once the child is added
+     */
+    void setAddingLastChild(bool adding) { addingLastChild = adding; }
+
+    /**
+     * @return True if every action of this Node has its child
+     */
+    bool hasAllChildren() const { return expansion == FULLY_EXPANDED && !addingLastChild; }
+
+    /**
+     * @brief Remove all children and restart expansion from the first action
+     *
+     * The statistics of this Node itself are kept. The ExpansionStrategy must
+     * have been released by its owner.
+     */
+    void removeChildren()
+    {
+        std::vector<NodeIndex>().swap(children);
+        std::vector<A>().swap(childActions);
+        std::vector<int>().swap(childVisits);
+        std::vector<float>().swap(childScoreSums);
+        extras.reset();
+        childActionsStored = false;
+        expansion = NOT_EXPANDED;
+    }
+
+    /**
+     * @return True if it may still be possible to add children, a Node that
+     * was never expanded is assumed to have actions left
+     */
+    bool shouldExpand() const { return children.empty() || expansion != FULLY_EXPANDED; }
+
+    /**
+     * @brief Update this Node's score and increment the number of visits.
+     *
+     * Only one thread may update this Node at a time, see updateConcurrent().
+     *
+     * @param score
+     * @param visits The number of visits the score was summed over
+     */
+    void update(float score, int visits = 1)
+    {
+        scoreSum.store(scoreSum.load(std::memory_order_relaxed) + score, std::memory_order_relaxed);
+        numVisits.store(numVisits.load(std::memory_order_relaxed) + visits, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Update this Node's score and increment the number of visits while
+     * other threads may update it as well
+     * @param score
+     * @param virtualLoss The virtual loss added by addVirtualLoss() to remove
+     * @param visits The number of visits the score was summed over
+     */
+    void updateConcurrent(float score, int virtualLoss, int visits = 1)
+    {
+        float expected = scoreSum.load(std::memory_order_relaxed);
+        while (!scoreSum.compare_exchange_weak(expected, expected + score, std::memory_order_relaxed)) {
+        }
+        numVisits.fetch_add(visits - virtualLoss, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count visits without a score, until updateConcurrent() removes them
+     * @param virtualLoss The number of visits to add
+     */
+    void addVirtualLoss(int virtualLoss) { numVisits.fetch_add(virtualLoss, std::memory_order_relaxed); }
+
+    /**
+     * @brief Acquire the lock guarding the children and the ExpansionStrategy
+     *
+     * Together with unlock() this makes a Node usable with std::unique_lock.
+     */
+    void lock()
+    {
+        while (busy.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+    /**
+     * @brief Release the lock acquired by lock()
+     */
+    void unlock() { busy.clear(std::memory_order_release); }
+
+    /**
+     * @brief Record when this Node was last visited
+     * @param time The value of a clock increasing with every visit
+     */
+    void touch(std::uint32_t time) { lastVisit = time; }
+
+    /**
+     * @return The time passed to touch() on the last visit
+     */
+    std::uint32_t getLastVisit() const { return lastVisit; }
+
+    /**
+     * @return The total score divided by the number of visits.
+     */
+    float getAvgScore() const
+    {
+        return scoreSum.load(std::memory_order_relaxed) / numVisits.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return The number of times updateScore(score) was called
+     */
+    int getNumVisits() const { return numVisits.load(std::memory_order_relaxed); }
+
+    /**
+     * @return True if the outcome of this Node is proven, see MCTS::setSolver()
+     */
+    bool isSolved() const { return !std::isnan(solvedResult.load(std::memory_order_relaxed)); }
+
+    /**
+     * @return The result of Scoring::score() reached from this Node with
+     * perfect play, only meaningful if isSolved() is true
+     */
+    float getSolvedResult() const { return solvedResult.load(std::memory_order_relaxed); }
+
+    /**
+     * @param result The proven result of Scoring::score() reached from this Node
+     */
+    void setSolvedResult(float result) { solvedResult.store(result, std::memory_order_relaxed); }
+
+private:
+    /** @return The extra data of the children, empty if it was never allocated */
+    const ChildExtras& getExtras() const
+    {
+        static const ChildExtras none;
+        return extras ? *extras : none;
+    }
+
+    /** @return The extra data of the children, allocated on the first call */
+    ChildExtras& allocateExtras()
+    {
+        if (!extras)
+            extras.reset(new ChildExtras());
+        return *extras;
+    }
+};
+
+/**
+ * @brief AI search technique for finding the best Action give a certain State
+ *
+ * The MCTS algorithm has four stages: selection, expansion, playout and
+ * backpropagation. This class represents the general framework for executing
+ * these stages and uses a number of user-implemented classes which implement
+ * the game rules.
+ *
+ * In the selection stage, MCTS uses the UCT formula to select the best node (or
+ * randomly if a node has not been visited often enough, see
+ * MCTS::setMinVisits()) until it finds a node that still has nodes left to be
+ * expanded. The UCT formula has one parameter, see MCTS::setC(). When an
+ * ActionHash is set (see MCTS::setActionHash()), the progressive history
+ * heuristic influences the selection based on the success of an action in
+ * earlier iterations. MCTS::setW() is used to set the W parameter for
+ * progressive history. With RAVE (see MCTS::setRave()), the average score of a
+ * child is blended with the score of its action in all iterations that played
+ * it later on, which is trusted less as the child gets visits.
+ *
+ * In the expansion stage an action is requested from the ExpansionStrategy and
+ * a node is expanded using that action. When a node is not visited at least T
+ * times, expansion is skipped (see MCTS::setMinT()).
+ *
+ * In the playout stage, the PlayoutStrategy is used to generate moves until the
+ * end of the game is reached. When a terminal state (the end of the game) is
+ * encoutered, the score is calculated using Scoring.
+ *
+ * In the backpropagation stage, Node::update() is called for each node from the
+ * node expanded in the expansion stage to the root node. The score passed to
+ * Node::update() is the one from the call to Scoring::score() passed to
+ * Backpropagation::updateScore() for each call to Node::update().
+ *
+ * With MCTS::setSolver(), terminal results are proven and propagated up the
+ * tree with minimax logic. Solved subtrees are no longer searched and the
+ * search ends as soon as the outcome of the root is proven.
+ *
+ * The time that MCTS is allowed to search van be set by MCTS::setTime(). The
+ * deadline is measured with a monotonic clock that is read only every few
+ * iterations, see MCTS::setTimeSlack().
+ *
+ * An MCTS instance can be reused for consecutive moves of a game. After an
+ * action is played, MCTS::advance() makes the matching child the new root,
+ * keeping the statistics of its subtree for the next call to calculateAction().
+ * This requires Action to implement operator==.
+ *
+ * Optionally, MCTS::setTranspositions() lets states reached through different
+ * sequences of actions share one node and its statistics.
+ *
+ * The size of the tree can be limited with MCTS::setMaxNodes() or
+ * MCTS::setMaxMemory(). When the limit is reached, MCTS stops expanding or
+ * evicts subtrees and reuses their memory, see MemoryLimitPolicy. With
+ * MCTS::setLazyChildren(), children visited only once do not get a node.
+ *
+ * Nodes are allocated from an ObjectPool owned by this MCTS instance, the
+ * whole tree is released at once when the MCTS instance is destroyed.
+ *
+ * By default every node stores a copy of its state. For large states,
+ * MCTS::setStateStorage() trades memory for CPU time by storing only some
+ * states and rebuilding the others from their closest stored ancestor. When
+ * Action implements undo(), no states are copied during an iteration at all,
+ * see IsUndoable.
+ *
+ * Several threads can search the tree at once, see MCTS::setNumThreads(). A
+ * virtual loss (see MCTS::setVirtualLoss()) is added to every node on the path
+ * of a thread until its playout is backpropagated, which steers the other
+ * threads to different paths. Alternatively, MCTS::setLeafParallelism() runs
+ * several playouts from every leaf at once. The threads are workers of a
+ * ThreadPool that lives as long as the MCTS instance, or longer when it is
+ * shared with other instances, see MCTS::setThreadPool().
+ *
+ * MCTS::calculateActionAsync() searches in the background and returns an
+ * AsyncSearch, which reports the best action found so far and can stop the
+ * search early. MCTS::startPondering() keeps searching while the opponent
+ * thinks and keeps the subtree of the action it plays.
+ *
+ * Backpropagation, TerminationCheck and Scoring are called several times per
+ * iteration. By default they are called through their virtual interfaces. When
+ * the concrete types are passed as template parameters B, TC and S instead, the
+ * policies are stored by value and their calls can be inlined, see
+ * PolicyHolder.
+ *
+ * The game types do not have to derive from State, Action, ExpansionStrategy
+ * or PlayoutStrategy. Any types with the same member functions can be used,
+ * which removes the vtable pointers from every Node and lets the calls be
+ * inlined. ExpansionStrategy can also be stateless, see ExpansionAccess. When
+ * compiled as C++20, the requirements are checked with concepts such as
+ * GameState and GameExpansionStrategy.
+ *
+ * @tparam T The State type this MCTS operates on
+ * @tparam A The Action type this MCTS operates on
+ * @tparam E The ExpansionStrategy this MCTS uses
+ * @tparam P The PlayoutStrategy this MCTS uses
+ * @tparam B The Backpropagation this MCTS uses
+ * @tparam TC The TerminationCheck this MCTS uses
+ * @tparam S The Scoring this MCTS uses
+ */
+template <class T, class A, class E, class P, class B = Backpropagation<T>, class TC = TerminationCheck<T>,
+    class S = Scoring<T>>
+#if defined(CPP_MCTS_CONCEPTS)
+    requires GameState<T> && GameAction<A, T> && GameExpansionStrategy<E, T, A> && GamePlayoutStrategy<P, T, A>
+    && GameBackpropagation<B, T> && GameTerminationCheck<TC, T> && GameScoring<S, T>
+#endif
+class MCTS {
+    /** Default thinking time in milliseconds */
+    const int DEFAULT_TIME = 500;
+
+    /** MCTS can go over time if it has less than this amount of iterations */
+    const int DEFAULT_MIN_ITERATIONS = 0;
+
+    /** Default C for the UCT formula */
+    static constexpr float DEFAULT_C = 0.5;
+
+    /** Default W for progressive history */
+    static constexpr float DEFAULT_W = 5.0;
+
+    /** A proven score of at least this value is a win that needs no further search, see setSolver() */
+    const float WIN_SCORE = 1.0F;
+
+    /** Default number of visits at which RAVE and the child's own score are weighted equally */
+    static constexpr unsigned int DEFAULT_RAVE_EQUIVALENCE = 1000;
+
+    /** Minimum number of visits until a Node will be expanded */
+    const int DEFAULT_MIN_T = 5;
+
+    /** Default number of visits until a node can be selected using UCT instead of
+     * randomly */
+    const int DEFAULT_MIN_VISITS = 5;
+
+    /** Default number of visits without score added to a node on the path of a thread */
+    const int DEFAULT_VIRTUAL_LOSS = 1;
+
+    /** Default time the search may end after the deadline */
+    const std::chrono::microseconds::rep DEFAULT_TIME_SLACK = 1000;
+
+    /** The maximum number of iterations between two reads of the clock */
+    const unsigned int MAX_CHECK_INTERVAL = 1U << 16U;
+
+    /** Default number of levels between two stored states with StateStorage::CHECKPOINT */
+    static constexpr unsigned int DEFAULT_CHECKPOINT_INTERVAL = 8;
+
+    /** Monotonic clock used for the search deadline */
+    using Clock = std::chrono::steady_clock;
+
+    /** True if A can be undone, which makes the threads play on a single working state */
+    using Undoable = IsUndoable<A, T>;
+
+    PolicyHolder<B> backprop;
+    PolicyHolder<TC> termination;
+    PolicyHolder<S> scoring;
+
+    /** Storage for all nodes in the search tree */
+    ObjectPool<Node<T, A, E>> nodes;
+
+    /** The ExpansionStrategies of the nodes that are partially expanded */
+    ObjectPool<E> expansions;
+
+    /** The states of the nodes that store their state */
+    ObjectPool<T> states;
+
+    NodeIndex root;
+
+    /** The time MCTS is allowed to search */
+    std::chrono::milliseconds allowedComputationTime = std::chrono::milliseconds(DEFAULT_TIME);
+
+    /** MCTS can go over time if it has less than this amount of iterations */
+    int minIterations = DEFAULT_MIN_ITERATIONS;
+
+    /** How long the search may continue after the deadline */
+    Clock::duration timeSlack = std::chrono::microseconds(DEFAULT_TIME_SLACK);
+
+    /** Stop at the deadline even when minIterations is not reached */
+    bool hardDeadline = false;
+
+    /** The time the last search ended after its deadline, negative if it ended before */
+    Clock::duration overshoot = Clock::duration::zero();
+
+    /** Tunable bias parameter for node selection */
+    float C = DEFAULT_C;
+
+    /** Weight of the progressive history term in the selection */
+    float W = DEFAULT_W;
+
+    /** Visits at which the RAVE and UCT scores are weighted equally, 0 disables RAVE */
+    unsigned int raveEquivalence = 0;
+
+    /** Prove the outcome of nodes from terminal states, see setSolver() */
+    bool solver = false;
+
+    /** Minimum number of visits until a Node will be expanded */
+    int minT = DEFAULT_MIN_T;
+
+    /** Minimum number of visits until a Node will be selected using the UCT
+     * formula, below this number random selection is used */
+    int minVisits = DEFAULT_MIN_VISITS;
+
+    /** Visits without score added to the nodes on the path of a thread */
+    int virtualLoss = DEFAULT_VIRTUAL_LOSS;
+
+    /** Which nodes store their state */
+    StateStorage stateStorage = StateStorage::FULL;
+
+    /** Number of levels between two stored states with StateStorage::CHECKPOINT */
+    unsigned int checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+
+    /** Add new children as edges and create their nodes on their second visit */
+    bool lazyChildren = false;
+
+    /** The number of playouts run from every leaf at once */
+    unsigned int leafPlayouts = 1;
+
+    /** Runs the searching threads and the playouts of a leaf, nullptr until needed */
+    std::shared_ptr<ThreadPool> threadPool;
+
+    /** True if threadPool was created by this MCTS and is sized for it */
+    bool ownsThreadPool = false;
+
+    /** The number of iterations of the last search */
+    unsigned int iterations = 0;
+
+    /** Only set while a search started by calculateActionAsync() runs */
+    std::shared_ptr<SearchProgress<A>> progress;
+
+    /**
+     * Backpropagation::updateScore() of the state after a playout action, at
+     * the scores 0 and 1. The playout's score is only known at its end, when
+     * the state is gone, so updateScore() is interpolated between them.
+     */
+    struct Perspective {
+        float loss;
+        float win;
+
+        float of(float score) const { return loss + (win - loss) * score; }
+    };
+
+    /** A step on the path from the root to the node selected in an iteration */
+    struct Step {
+        NodeIndex node;
+        /** Position of node in its parent's children */
+        std::uint32_t slot;
+        /** True if the parent keeps the action leading to node, which is then copied to SearchContext::pathActions */
+        bool parentAction;
+    };
+
+    /** A playout run next to the playout of a searching thread, see setLeafParallelism() */
+    struct LeafPlayout {
+        std::mt19937 generator;
+        std::unique_ptr<T> state;
+        std::unique_ptr<P> playout;
+        float score = 0.0F;
+    };
+
+    /** The state of one searching thread */
+    struct SearchContext {
+        /** Random generator used in node selection and playouts */
+        std::mt19937 generator;
+
+        /** The state the playouts of this thread are played on, created by the first playout. For
+         * undoable actions this is the working state that the whole iteration is played on. */
+        std::unique_ptr<T> playoutState;
+
+        /** The PlayoutStrategy of this thread, acting on playoutState */
+        std::unique_ptr<P> playout;
+
+        /** The nodes visited in the current iteration, starting at the root */
+        std::vector<Step> path;
+
+        /** The state of every node in path, either stored in the node or in stateBuffers */
+        std::vector<const T*> pathStates;
+
+        /** Rebuilt states of nodes that do not store their state, indexed by depth */
+        std::vector<std::unique_ptr<T>> stateBuffers;
+
+        /** The actions executed on the working state in the current iteration, for undoable actions */
+        std::vector<A> undoActions;
+
+        /** The actions leading to the steps of path whose parent keeps them, indexed by depth. Copied while the
+         * parent is locked, since other threads may add children to it. */
+        std::vector<A> pathActions;
+
+        /** The actions generated by E::generateAll(), reused between expansions */
+        std::vector<A> actions;
+
+        /** The playouts run next to playout, see setLeafParallelism() */
+        std::vector<LeafPlayout> leafPlayouts;
+
+        /** The average score of every action in the iterations of this thread, see setActionHash() */
+        HistoryTable history;
+
+        /** The actions of the playout of the current iteration, when they are not in undoActions */
+        std::vector<A> playoutActions;
+
+        /** How the score of the playout translates to each of its actions, for progressive history */
+        std::vector<Perspective> playoutPerspectives;
+
+        /** The hashes of the actions played below the node being backpropagated, for RAVE. Sorted during
+         * backProp() so updateAmaf() can search it, and reused between iterations. */
+        std::vector<std::size_t> amafActions;
+
+        /** The number of iterations this thread did in the last search */
+        unsigned int iterations = 0;
+    };
+
+    /** State shared by the threads of a search with more than one thread */
+    struct SharedSearch {
+        /** Guards the ObjectPool and the transposition table */
+        std::mutex treeMutex;
+
+        /** The number of iterations started by all threads */
+        std::atomic<unsigned int> iterations { 0 };
+
+        /** Nodes that threads are about to add, counted towards maxNodes */
+        std::uint32_t reserved = 0;
+    };
+
+    /** One context per thread, the calling thread uses the first */
+    std::vector<SearchContext> contexts = std::vector<SearchContext>(1);
+
+    /** The seed of the first context, context i is seeded with seed + i */
+    unsigned int seed = std::mt19937::default_seed;
+
+    /** Only set while more than one thread is searching */
+    SharedSearch* shared = nullptr;
+
+    /** Hash used to find transpositions, transpositions are not detected when nullptr */
+    std::unique_ptr<StateHash<T>> stateHash;
+
+    /** Hash used for progressive history, which is disabled when nullptr */
+    std::unique_ptr<ActionHash<A>> actionHash;
+
+    /** The history table of every thread has 2^historyBits entries */
+    unsigned int historyBits = HistoryTable::DEFAULT_BITS;
+
+    /** Selection statistics for nodes with several parents */
+    TranspositionBackup transpositionBackup = TranspositionBackup::EDGE;
+
+    /** All nodes in the tree by the hash of their state */
+    std::unordered_multimap<std::size_t, NodeIndex> transpositions;
+
+    /** The maximum number of nodes in the tree */
+    std::uint32_t maxNodes = std::numeric_limits<std::uint32_t>::max();
+
+    /** What to do when the tree has maxNodes nodes */
+    MemoryLimitPolicy memoryLimitPolicy = MemoryLimitPolicy::STOP_EXPANDING;
+
+    /** Total number of nodes removed to stay below maxNodes */
+    std::uint64_t numEvicted = 0;
+
+    /** Incremented every iteration, used to find the nodes visited longest ago */
+    std::uint32_t visitClock = 0;
+
+    /** A single worker running the searches of calculateActionAsync() and startPondering(), nullptr until needed */
+    std::unique_ptr<ThreadPool> searchThread;
+
+    /** The search started by startPondering(), declared last so it is stopped before the tree is destroyed */
+    AsyncSearch<A> ponderSearch;
+
+public:
+    /**
+     * @note backprop, termination and scoring will be deleted by this MCTS
+     * instance when passed as pointers. With concrete policy types they can
+     * also be passed by value.
+     */
+    MCTS(const T& rootData, PolicyHolder<B> backprop, PolicyHolder<TC> termination, PolicyHolder<S> scoring)
+        : backprop(std::move(backprop))
+        , termination(std::move(termination))
+        , scoring(std::move(scoring))
+        , root(createNode(states.create(rootData), NO_NODE, A()))
+    {
+    }
+
+    MCTS(const MCTS& other) = delete;
+    MCTS(MCTS&& other) noexcept = default;
+
+    MCTS& operator=(const MCTS& other) = delete;
+    MCTS& operator=(MCTS&& other) noexcept = default;
+
+    /**
+     * @brief Runs the MCTS algorithm and searches for the best Action
+     *
+     * @return The Action found by MCTS
+     */
+    A calculateAction()
+    {
+        search();
+        return getBestAction();
+    }
+
+    /**
+     * @brief Start calculateAction() in the background and return right away
+     *
+     * The returned handle reports the best action found so far while the
+     * search continues, can stop the search early and waits for its result.
+     * This MCTS instance must not be used, moved or destroyed until the search
+     * has ended. Destroying the handle stops the search and waits for it.
+     *
+     * @return The handle of the search
+     */
+    AsyncSearch<A> calculateActionAsync()
+    {
+        stopPondering();
+        return startAsync([this]() { return calculateAction(); });
+    }
+
+#if defined(CPP_MCTS_STOP_TOKEN)
+    /**
+     * @brief Start calculateAction() in the background, stopping it early when a
+     * stop is requested through the given token
+     *
+     * @see calculateActionAsync()
+     */
+    AsyncSearch<A> calculateActionAsync(std::stop_token stopToken)
+    {
+        AsyncSearch<A> handle = calculateActionAsync();
+        handle.stopOn(std::move(stopToken));
+        return handle;
+    }
+#endif
+
+    /**
+     * @brief Keep searching from the current root in the background until
+     * the next action is played
+     *
+     * Call this after advancing the tree along the own action, so the tree
+     * keeps growing below the actions of the opponent while it thinks. When
+     * advance() is called with the action the opponent played, pondering stops
+     * and the subtree of that action becomes the root with all its visits.
+     * advance() returns true on such a ponder hit.
+     *
+     * Pondering has no time limit, it continues until stopPondering(),
+     * advance(), search() or calculateAction() is called. Use setMaxNodes() to
+     * bound the memory it uses. No other member function may be called while
+     * pondering, and this MCTS instance must not be moved. Nothing happens
+     * when the root is terminal or proven, see setSolver().
+     */
+    void startPondering()
+    {
+        stopPondering();
+        if (termination->isTerminal(nodes[root].getData()) || nodes[root].isSolved())
+            return;
+
+        // The action of a ponder search is discarded, only its tree is kept for advance()
+        ponderSearch = startAsync([this]() {
+            searchUntil(Clock::time_point::max());
+            return A();
+        });
+    }
+
+    /**
+     * @brief Stop the search started by startPondering() and wait until it has ended
+     *
+     * @return The number of iterations done while pondering, 0 if this MCTS
+     * was not pondering
+     */
+    unsigned int stopPondering()
+    {
+        if (!ponderSearch.valid())
+            return 0;
+
+        ponderSearch.requestStop();
+        ponderSearch.get();
+        return ponderSearch.getIterations();
+    }
+
+    /**
+     * @return True if the search started by startPondering() is running
+     */
+    bool isPondering() const { return ponderSearch.valid(); }
+
+    /**
+     * @return The search started by startPondering(), e.g. to read the action
+     * the opponent is expected to play. Only valid while isPondering().
+     */
+    const AsyncSearch<A>& getPonderSearch() const { return ponderSearch; }
+
+    /**
+     * @brief Run the selection, expansion, playout and backpropagation stages
+     * until the allowed computation time has passed
+     *
+     * calculateAction() calls this before choosing an action. Stops pondering
+     * first.
+     */
+    void search()
+    {
+        stopPondering();
+
+        Clock::time_point deadline = Clock::now() + allowedComputationTime;
+        searchUntil(deadline);
+        overshoot = Clock::now() - deadline;
+    }
+
+    /**
+     * @return The Action with the best average score at the root, or a random
+     * Action if the root has not been expanded
+     */
+    A getBestAction()
+    {
+        // Select the Action with the best score
+        const Node<T, A, E>& rootNode = nodes[root];
+        auto& children = rootNode.getChildren();
+        std::size_t best = children.size();
+        float bestScore = -std::numeric_limits<float>::max();
+
+        // A proven root is decided by its best proven child, however few visits it has
+        if (rootNode.isSolved())
+            best = bestSolvedChild(rootNode);
+
+        for (std::size_t i = 0; i < children.size() && !rootNode.isSolved(); i++) {
+            float score = rootNode.getChildScoreSums()[i] / rootNode.getChildVisits()[i];
+            if (score > bestScore) {
                 bestScore = score;
-                best = children[i];
+                best = i;
+            }
+        }
+
+        // If no expansion took place, simply execute a random action
+        if (best == children.size()) {
+            A action;
+            T state(nodes[root].getData());
+            auto playout = P(&state);
+            bindGenerator(playout, &contexts[0].generator, 0);
+            playout.generateRandom(action);
+            return action;
+        }
+
+        return childAction(rootNode, best);
+    }
+
+    /**
+     * @brief Move the root of the tree along a played action
+     *
+     * When the root has a child reached by the given action, that child becomes
+     * the new root and its subtree, including all visits and scores, is kept.
+     * All other nodes are released. Otherwise the tree is replaced by a single
+     * root holding the result of executing the action on the current root.
+     *
+     * Call this for every action played in the game, including the ones
+     * returned by calculateAction().
+     *
+     * Stops pondering first, see startPondering().
+     *
+     * @param action The action that was played
+     * @return True if an existing subtree was reused
+     */
+    bool advance(const A& action)
+    {
+        stopPondering();
+
+        const Node<T, A, E>& current = nodes[root];
+        for (std::size_t i = 0; i < current.getChildren().size(); i++) {
+            NodeIndex child = current.getChildren()[i];
+            // A child without a node has no subtree to keep
+            if (child == NO_NODE || !(childAction(current, i) == action))
+                continue;
+            Node<T, A, E>& next = nodes[child];
+            // The root always stores its state
+            if (!next.hasData()) {
+                T* data = states.create(current.getData());
+                A(action).execute(*data);
+                next.setData(data);
+            }
+            keepSubtree(child);
+            return true;
+        }
+
+        T data(current.getData());
+        A executed(action);
+        executed.execute(data);
+        nodes.clear();
+        expansions.clear();
+        states.clear();
+        replaceRoot(std::move(data), std::move(executed));
+        return false;
+    }
+
+    /**
+     * @brief Start a new tree searching from the given state
+     *
+     * All nodes are released, but the memory of the tree is kept for the
+     * nodes of the new tree, so a tree can be reused for many unrelated
+     * searches without allocating its nodes every time. The settings and
+     * policies of this MCTS are kept, the history of actions (see
+     * setActionHash()) is forgotten.
+     *
+     * @param rootData The state to search from
+     */
+    void reset(const T& rootData)
+    {
+        stopPondering();
+
+        nodes.reset();
+        expansions.reset();
+        states.reset();
+        for (auto& context : contexts) {
+            if (context.history.getBits() > 0)
+                context.history.reset(context.history.getBits());
+        }
+        iterations = 0;
+        replaceRoot(T(rootData), A());
+    }
+
+    /**
+     * @brief Share nodes between states reached by different sequences of actions
+     *
+     * When a node is expanded and a node with an equal state already exists,
+     * the existing node is added as a child instead of creating a new one. The
+     * game must not be able to reach a state again after leaving it.
+     *
+     * @note hash will be deleted by this MCTS instance
+     *
+     * @param hash Hash used to find equal states, nullptr to stop detecting
+     * transpositions
+     * @param backup The statistics selection uses for a shared child
+     */
+    void setTranspositions(StateHash<T>* hash, TranspositionBackup backup = TranspositionBackup::EDGE)
+    {
+        stateHash.reset(hash);
+        transpositionBackup = backup;
+        transpositions.clear();
+        if (stateHash) {
+            for (NodeIndex i = 0; i < nodes.bound(); i++) {
+                if (nodes.contains(i) && nodes[i].hasData())
+                    transpositions.emplace(stateHash->hash(nodes[i].getData()), i);
+            }
+        }
+    }
+
+    /**
+     * @brief Choose which nodes store a copy of their state
+     *
+     * Storing every state (StateStorage::FULL) is fastest. With
+     * StateStorage::REPLAY only the root stores its state and every iteration
+     * rebuilds the states on its path by executing the actions from the root,
+     * which saves the memory of all other states. StateStorage::CHECKPOINT
+     * stores the state of every interval-th level, so states are rebuilt from
+     * at most interval - 1 levels above. Rebuilding copies each state on the
+     * path once, so State should be cheap to copy assign.
+     *
+     * With undoable actions (see IsUndoable), states are not rebuilt from
+     * stored states but walked down from the root on a working state, so
+     * StateStorage::REPLAY saves memory without extra copies.
+     *
+     * Nodes already in the tree keep their state. Transpositions (see
+     * setTranspositions()) require StateStorage::FULL.
+     *
+     * @param storage Which nodes store their state
+     * @param interval The number of levels between stored states with
+     * StateStorage::CHECKPOINT, at least 1
+     */
+    void setStateStorage(StateStorage storage, unsigned int interval = DEFAULT_CHECKPOINT_INTERVAL)
+    {
+        this->stateStorage = storage;
+        this->checkpointInterval = std::max(interval, 1U);
+    }
+
+    /**
+     * @brief Add new children as edges instead of nodes
+     *
+     * An edge is the action and statistics of a child, kept by its parent. The
+     * node and state of the child are created when the edge is selected
+     * again, so the many children that are visited only once do not cost a
+     * node or a state. Such a child does not appear in the tree yet, its
+     * position in Node::getChildren() holds NO_NODE. A node created for an
+     * edge does not count the visit the edge had before.
+     *
+     * @param lazy True to add new children as edges
+     */
+    void setLazyChildren(bool lazy) { this->lazyChildren = lazy; }
+
+    /**
+     * @brief Run several playouts from every leaf at once
+     *
+     * Every iteration selects a leaf as usual and then runs the given number
+     * of playouts from it in parallel, one on the searching thread and the
+     * others on the pool. The average of their scores is backpropagated once,
+     * counting as one visit per playout. This uses spare cores without
+     * sharing the tree between threads and pays off when playouts are
+     * expensive compared to the rest of an iteration.
+     *
+     * Each playout has its own state, PlayoutStrategy and random generator.
+     * TerminationCheck and Scoring are called from several threads at once.
+     * Backpropagation receives the average score, which gives the same
+     * statistics as backpropagating every score when it is linear in the score.
+     *
+     * @param playouts The number of playouts per iteration, 1 to run only one
+     * @param pool The pool running the playouts, see setThreadPool(). When
+     * nullptr, the pool set before is kept.
+     */
+    void setLeafParallelism(unsigned int playouts, std::shared_ptr<ThreadPool> pool = nullptr)
+    {
+        this->leafPlayouts = std::max(playouts, 1U);
+        if (pool)
+            setThreadPool(std::move(pool));
+        else
+            releaseOwnedThreadPool();
+    }
+
+    /**
+     * @brief Set the pool running the searching threads and leaf playouts
+     *
+     * The pool is kept across searches, so no threads are created per search.
+     * Several MCTS instances can share one pool, e.g. one searching per game.
+     * When no pool is set, the first search that needs one creates a pool with
+     * a worker for every thread and playout besides the calling thread.
+     *
+     * The calling thread always takes part in the search, so a pool with fewer
+     * workers than needed only makes the search less parallel.
+     *
+     * @param pool The pool to use, nullptr to let this MCTS create its own
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> pool)
+    {
+        this->threadPool = std::move(pool);
+        this->ownsThreadPool = false;
+    }
+
+    /**
+     * @return The pool running the searching threads and leaf playouts,
+     * nullptr if none was set or needed yet
+     */
+    std::shared_ptr<ThreadPool> getThreadPool() const { return threadPool; }
+
+    /**
+     * @return The number of states stored in the tree
+     */
+    std::uint32_t getNumStoredStates() const { return states.size(); }
+
+    /**
+     * Set the allowed computation time in milliseconds
+     * @param time In milliseconds
+     */
+    void setTime(int time) { this->allowedComputationTime = std::chrono::milliseconds(time); }
+
+    /**
+     * @brief Set how long a search may continue after its deadline
+     *
+     * The search reads the clock once every few iterations, adapting the
+     * number of iterations to their measured duration so that the clock is
+     * read about once per slack. A larger slack reads the clock less often but
+     * ends the search later, a slack of zero reads it every iteration.
+     *
+     * @param slack The time after the deadline, 1 ms by default
+     */
+    void setTimeSlack(std::chrono::microseconds slack) { this->timeSlack = slack; }
+
+    /**
+     * @brief Stop the search at the deadline even if the minimum number of
+     * iterations is not reached
+     *
+     * @see setMinIterations()
+     * @param hard True to let the deadline take precedence over the minimum
+     * number of iterations
+     */
+    void setHardDeadline(bool hard) { this->hardDeadline = hard; }
+
+    /**
+     * @return How long the last search ran past its deadline, negative if it
+     * ended before the deadline
+     */
+    std::chrono::microseconds getOvershoot() const { return std::chrono::duration_cast<std::chrono::microseconds>(overshoot); }
+
+    /**
+     * @brief Set the C parameter of the UCT formula
+     * @param newC The C parameter
+     */
+    void setC(float newC) { this->C = newC; }
+
+    /**
+     * @brief Set the W parameter of progressive history
+     *
+     * A child is selected by its UCT value plus
+     *
+     *     W * history / ((1 - avgScore) * visits + 1)
+     *
+     * where history is the average score of the child's action over all
+     * iterations it was played in. The term fades as the child gets visits,
+     * and fades slower for children with a high average score.
+     *
+     * @see setActionHash()
+     * @param newW The W parameter, 5 by default. 0 disables progressive
+     * history, leaving the ActionHash to RAVE.
+     */
+    void setW(float newW) { this->W = newW; }
+
+    /**
+     * @brief Enable progressive history
+     *
+     * Every time an iteration is backpropagated, each action on its path in
+     * the tree is credited in a history table with the score the action's
+     * child received. The actions of the playout are credited as well, with
+     * Backpropagation::updateScore() of the state after each action. As the
+     * state is gone once the playout is scored, updateScore() is evaluated at
+     * the scores 0 and 1 and interpolated, so it should be affine in the
+     * score, such as the score itself or 1 - score. Playouts done by
+     * P::rollout() do not report their actions. Scores are assumed to be
+     * between 0 and 1.
+     *
+     * Each thread keeps its own table, so the tables are updated without
+     * synchronization. With tree parallelism (see setNumThreads()) every
+     * table therefore only learns from the iterations of its own thread,
+     * about 1/N of all iterations with N threads. When several threads
+     * search, the ActionHash is called concurrently.
+     *
+     * @see setW()
+     * @param hash Hashes the actions, this MCTS takes ownership. nullptr
+     * disables progressive history.
+     * @param bits The table of every thread has 2^bits entries, between 1
+     * and 32
+     * @throws std::invalid_argument If bits is out of range, hash is deleted
+     * and the previous ActionHash is kept
+     */
+    void setActionHash(ActionHash<A>* hash, unsigned int bits = HistoryTable::DEFAULT_BITS)
+    {
+        std::unique_ptr<ActionHash<A>> owned(hash);
+        HistoryTable::checkBits(bits);
+
+        this->actionHash = std::move(owned);
+        this->historyBits = bits;
+        for (auto& context : contexts)
+            context.history.reset(bits);
+    }
+
+    /**
+     * @brief Enable Rapid Action Value Estimation (RAVE)
+     *
+     * Every node counts, for each of its children, the iterations through the
+     * node in which the child's action was played later on, in the tree or in
+     * the playout, and their average score, the all-moves-as-first (AMAF)
+     * score. Selection uses
+     *
+     *     (1 - beta) * avgScore + beta * amafScore
+     *
+     * in place of the child's average score in the UCT formula, where
+     *
+     *     beta = sqrt(equivalence / (3 * visits + equivalence))
+     *
+     * so the AMAF score guides the selection among children with few visits.
+     * Actions are compared by their hash, so RAVE requires an ActionHash, see
+     * setActionHash(). Playouts done by P::rollout() do not report their
+     * actions, only the actions in the tree are counted then.
+     *
+     * @param equivalence The number of visits at which both scores are
+     * weighted equally, 0 disables RAVE
+     */
+    void setRave(unsigned int equivalence = DEFAULT_RAVE_EQUIVALENCE) { this->raveEquivalence = equivalence; }
+
+    /**
+     * @brief Enable the MCTS-Solver
+     *
+     * The result of a terminal state is proven the first time it is reached
+     * and cached on its node. A node is proven as soon as one of its children
+     * is a proven win, a score of at least 1 after Backpropagation::updateScore(),
+     * or once all its children are proven, taking the best of their scores.
+     * Proven children are no longer selected, and the search ends right away
+     * once the root is proven, even before the minimum number of iterations.
+     * getBestAction() then returns the action proving the outcome of the root.
+     *
+     * Scores are assumed to be at most 1, with 1 a win for the player choosing
+     * between the children.
+     *
+     * @param enable True to prove the outcome of nodes
+     */
+    void setSolver(bool enable) { this->solver = enable; }
+
+    /**
+     * @return True if the outcome of the root is proven, see setSolver()
+     */
+    bool isSolved() const { return nodes[root].isSolved(); }
+
+    /**
+     * @brief Set the minimal number of visits until a node is expanded
+     * @param newMinT the minimal number of visits
+     */
+    void setMinT(float newMinT) { this->minT = newMinT; }
+
+    /**
+     * Set the minimum number of visits until UCT is used instead of random
+     * selection during the selection stage.
+     * @param newMinVisits The minimal number of visits
+     */
+    void setMinVisits(int newMinVisits) { this->minVisits = newMinVisits; }
+
+    /**
+     * Set the minimum number of iterations required before calculateAction()
+     * returns.
+     *
+     * MCTS will go over time, set using setTime(int), if this number of
+     * iterations is not reached, unless setHardDeadline() is enabled.
+     *
+     * @param minVisits The minimum number of iterations
+     */
+    void setMinIterations(int i) { this->minIterations = i; }
+
+    /**
+     * @brief Limit the number of nodes in the tree
+     *
+     * When the limit is reached during a search, the tree stops growing or
+     * makes room by removing the children of nodes that are rarely or not
+     * recently visited. Those nodes keep their own statistics and are expanded
+     * again when they are visited often enough.
+     *
+     * @param newMaxNodes The maximum number of nodes, at least 1
+     * @param policy What to do when the tree reaches the limit
+     */
+    void setMaxNodes(std::uint32_t newMaxNodes, MemoryLimitPolicy policy = MemoryLimitPolicy::STOP_EXPANDING)
+    {
+        this->maxNodes = newMaxNodes;
+        this->memoryLimitPolicy = policy;
+    }
+
+    /**
+     * @brief Limit the memory used by the tree
+     *
+     * Converts the budget to a number of nodes, see setMaxNodes(). The states
+     * are counted according to the StateStorage, set it before calling this.
+     * Memory that the states and actions allocate themselves is not counted.
+     *
+     * @param bytes The maximum number of bytes used by the nodes
+     * @param policy What to do when the tree reaches the limit
+     */
+    void setMaxMemory(std::size_t bytes, MemoryLimitPolicy policy = MemoryLimitPolicy::STOP_EXPANDING)
+    {
+        // A node and the statistics its parent keeps for it
+        std::size_t perNode = sizeof(Node<T, A, E>) + sizeof(NodeIndex) + sizeof(int) + sizeof(float);
+        if (stateStorage == StateStorage::FULL)
+            perNode += sizeof(T);
+        else if (stateStorage == StateStorage::CHECKPOINT)
+            perNode += sizeof(T) / checkpointInterval;
+        std::size_t limit = bytes / perNode;
+        setMaxNodes((std::uint32_t)std::min<std::size_t>(std::max<std::size_t>(limit, 1), std::numeric_limits<std::uint32_t>::max()), policy);
+    }
+
+    /**
+     * @return The total number of nodes removed to stay within the limit set by
+     * setMaxNodes()
+     */
+    std::uint64_t getNumEvicted() const { return numEvicted; }
+
+    /**
+     * Get the root of the MCTS tree. Useful for printing.
+     * @see writeDotFile()
+     * @return The root of the MCTS tree
+     */
+    Node<T, A, E>& getRoot() { return nodes[root]; }
+
+    /**
+     * @return The index of the root of the MCTS tree
+     */
+    NodeIndex getRootIndex() const { return root; }
+
+    /**
+     * @param index The index of a Node in this tree, e.g. one returned by
+     * Node::getChildren()
+     * @return The Node with the given index
+     */
+    const Node<T, A, E>& getNode(NodeIndex index) const { return nodes[index]; }
+
+    /**
+     * @return The number of nodes in the search tree
+     */
+    std::uint32_t getNumNodes() const { return nodes.size(); }
+
+    /**
+     * @return The number of visits and the score sum of every action expanded
+     * at the root
+     */
+    std::vector<ActionStatistics<A>> getRootStatistics() const
+    {
+        const Node<T, A, E>& rootNode = nodes[root];
+        std::vector<ActionStatistics<A>> statistics;
+        for (std::size_t i = 0; i < rootNode.getChildren().size(); i++) {
+            statistics.push_back({ childAction(rootNode, i), rootNode.getChildVisits()[i], rootNode.getChildScoreSums()[i] });
+        }
+        return statistics;
+    }
+
+    /**
+     * @brief Seed the random generator used in node selection
+     *
+     * Instances searching the same state in parallel should use different seeds.
+     * With several threads (see setNumThreads()), thread i uses seed + i.
+     *
+     * @param seed The seed
+     */
+    void setSeed(unsigned int newSeed)
+    {
+        this->seed = newSeed;
+        for (std::size_t i = 0; i < contexts.size(); i++)
+            contexts[i].generator.seed(newSeed + (unsigned int)i);
+    }
+
+    /**
+     * @brief Set the number of threads searching the tree
+     *
+     * All threads search the same tree, so the memory used does not grow with
+     * the number of threads. The calling thread is one of them. Backpropagation,
+     * TerminationCheck, Scoring and the StateHash are shared by all threads and
+     * must be safe to call concurrently. Evicting nodes (see setMaxNodes()) is
+     * only supported with a single thread.
+     *
+     * The other threads are workers of the ThreadPool, see setThreadPool().
+     *
+     * @param numThreads The number of threads, at least 1
+     */
+    void setNumThreads(unsigned int numThreads)
+    {
+        contexts.resize(std::max(numThreads, 1U));
+        setSeed(seed);
+        releaseOwnedThreadPool();
+    }
+
+    /**
+     * @return The number of threads searching the tree
+     */
+    unsigned int getNumThreads() const { return (unsigned int)contexts.size(); }
+
+    /**
+     * @brief Set the virtual loss used when searching with more than one thread
+     *
+     * Every node on the path of a thread counts this many extra visits without
+     * score until the thread backpropagates its playout. Higher values spread
+     * the threads over more paths.
+     *
+     * @param newVirtualLoss The number of visits, 0 to disable virtual loss
+     */
+    void setVirtualLoss(int newVirtualLoss) { this->virtualLoss = newVirtualLoss; }
+
+    /**
+     * @return The number of iterations done by the last call to calculateAction(),
+     * added up over all threads
+     */
+    unsigned int getIterations() const { return iterations; }
+
+private:
+    /** Run iterations on all threads until the deadline has passed or the AsyncSearch is stopped */
+    void searchUntil(Clock::time_point deadline)
+    {
+        if (contexts.size() > 1 && maxNodes != std::numeric_limits<std::uint32_t>::max() && memoryLimitPolicy != MemoryLimitPolicy::STOP_EXPANDING)
+            throw std::logic_error("Evicting nodes is not supported when searching with more than one thread");
+        if (stateHash && stateStorage != StateStorage::FULL)
+            throw std::logic_error("Transpositions require every node to store its state");
+        if (raveEquivalence > 0 && !actionHash)
+            throw std::logic_error("RAVE requires an ActionHash");
+
+        if ((contexts.size() > 1 || leafPlayouts > 1) && !threadPool) {
+            // The calling thread is one of the searching threads
+            threadPool = std::make_shared<ThreadPool>((unsigned int)contexts.size() * leafPlayouts - 1);
+            ownsThreadPool = true;
+        }
+
+        if (contexts.size() == 1) {
+            run(contexts[0], deadline);
+            iterations = contexts[0].iterations;
+        } else {
+            SharedSearch sharedSearch;
+            shared = &sharedSearch;
+
+            threadPool->run(contexts.size(), [this, deadline](std::size_t i) { run(contexts[i], deadline); });
+            shared = nullptr;
+
+            iterations = 0;
+            for (const auto& context : contexts)
+                iterations += context.iterations;
+        }
+    }
+
+    /**
+     * Start a search on the search thread of this MCTS, running the given
+     * function. The thread is created by the first call and kept until this
+     * MCTS is destroyed, so background searches do not create a thread each.
+     *
+     * @param searchAndChoose Searches and returns the action of the AsyncSearch
+     */
+    template <class F>
+    AsyncSearch<A> startAsync(F searchAndChoose)
+    {
+        auto searchProgress = std::make_shared<SearchProgress<A>>(getBestAction());
+        searchProgress->publish(getRootStatistics(), 0);
+
+        // The search resets progress when it ends, the handle keeps its own reference
+        progress = searchProgress;
+
+        // std::function needs a copyable task, so the packaged_task is shared
+        auto task = std::make_shared<std::packaged_task<A()>>([this, searchAndChoose]() {
+            try {
+                A action = searchAndChoose();
+                progress->publish(getRootStatistics(), iterations);
+                progress = nullptr;
+                return action;
+            } catch (...) {
+                progress = nullptr;
+                throw;
+            }
+        });
+        std::future<A> result = task->get_future();
+
+        if (!searchThread)
+            searchThread.reset(new ThreadPool(1));
+        searchThread->submit([task]() { (*task)(); });
+        return AsyncSearch<A>(std::move(searchProgress), std::move(result));
+    }
+
+    /** Make a single node holding the given state the root of the emptied tree */
+    void replaceRoot(T data, A action)
+    {
+        transpositions.clear();
+        root = createNode(states.create(std::move(data)), NO_NODE, std::move(action));
+        if (stateHash)
+            transpositions.emplace(stateHash->hash(nodes[root].getData()), root);
+    }
+
+    /** Drop a pool created by this MCTS, the next search creates one of the right size */
+    void releaseOwnedThreadPool()
+    {
+        if (ownsThreadPool) {
+            threadPool = nullptr;
+            ownsThreadPool = false;
+        }
+    }
+
+    /**
+     * Run iterations on the calling thread until the search ends. The clock is
+     * only read every few iterations, as often as needed to stop within
+     * timeSlack of the deadline.
+     */
+    void run(SearchContext& context, Clock::time_point deadline)
+    {
+        context.iterations = 0;
+        if (Undoable::value)
+            resetWorkingState(context);
+        // Threads added by setNumThreads() start with an empty table
+        if (usesHistory() && context.history.getBits() != historyBits)
+            context.history.reset(historyBits);
+
+        // Iterations left until the clock is read, the first check is done right away
+        unsigned int untilCheck = 0;
+        unsigned int checkInterval = 1;
+        unsigned int iterationsAtCheck = 0;
+        Clock::time_point lastCheck = Clock::now();
+
+        while (true) {
+            if (progress && progress->isStopRequested())
+                break;
+            // Nothing is left to learn about a proven root
+            if (nodes[root].isSolved())
+                break;
+
+            unsigned int started = shared ? shared->iterations.fetch_add(1, std::memory_order_relaxed) : context.iterations;
+            bool mayStop = hardDeadline || started >= (unsigned int)std::max(minIterations, 0);
+
+            // An asynchronous search also reads the clock to publish its progress
+            if ((mayStop || progress) && untilCheck-- == 0) {
+                Clock::time_point now = Clock::now();
+                if (mayStop && now >= deadline)
+                    break;
+                if (progress && &context == &contexts[0])
+                    publishProgress(context);
+
+                Clock::duration remaining = mayStop ? deadline - now : timeSlack;
+                checkInterval = nextCheckInterval(now - lastCheck, context.iterations - iterationsAtCheck, checkInterval, remaining);
+                untilCheck = checkInterval - 1;
+                iterationsAtCheck = context.iterations;
+                lastCheck = now;
+            }
+
+            context.iterations++;
+            iterate(context);
+        }
+    }
+
+    /** Share the statistics of the root with the AsyncSearch of this search */
+    void publishProgress(const SearchContext& context)
+    {
+        std::vector<ActionStatistics<A>> statistics;
+        {
+            std::unique_lock<Node<T, A, E>> guard(nodes[root], std::defer_lock);
+            if (shared)
+                guard.lock();
+            statistics = getRootStatistics();
+        }
+        progress->publish(std::move(statistics), shared ? shared->iterations.load(std::memory_order_relaxed) : context.iterations);
+    }
+
+    /**
+     * Choose the number of iterations until the clock is read again, based on
+     * the time the iterations since the last check took. The next check is
+     * planned at most timeSlack from now and not after the deadline.
+     *
+     * @param elapsed The time since the clock was last read
+     * @param done The number of iterations since the clock was last read
+     * @param previous The previous number of iterations between checks
+     * @param remaining The time left until the deadline
+     */
+    unsigned int nextCheckInterval(Clock::duration elapsed, unsigned int done, unsigned int previous, Clock::duration remaining) const
+    {
+        if (done == 0)
+            return 1;
+
+        // Iterations faster than the clock resolution
+        if (elapsed.count() <= 0)
+            return std::min(previous * 2, MAX_CHECK_INTERVAL);
+
+        double perIteration = (double)elapsed.count() / done;
+        double window = (double)std::min<Clock::duration>(timeSlack, remaining).count();
+        double interval = std::min(window / perIteration, 2.0 * previous);
+        return (unsigned int)std::max(1.0, std::min(interval, (double)MAX_CHECK_INTERVAL));
+    }
+
+    /** Run the selection, expansion, playout and backpropagation stages once */
+    void iterate(SearchContext& context)
+    {
+        /**
+         * Selection
+         */
+        NodeIndex selected = root;
+        context.path.clear();
+        context.path.push_back({ root, 0, false });
+        context.amafActions.clear();
+        while (true) {
+            Node<T, A, E>& node = nodes[selected];
+            std::unique_lock<Node<T, A, E>> guard(node, std::defer_lock);
+            if (shared)
+                guard.lock();
+            // Another parent may have proven a transposition
+            if (node.shouldExpand() || node.isSolved())
+                break;
+
+            std::uint32_t slot = select(node, context);
+            selected = node.getChildren()[slot];
+            if (shared)
+                node.addChildVirtualLoss(slot, virtualLoss);
+            pushStep(context, node, slot);
+
+            // The child only exists as an edge, its node is created below
+            if (selected == NO_NODE)
+                break;
+            if (shared)
+                nodes[selected].addVirtualLoss(virtualLoss);
+        }
+
+        rebuildStates(context);
+        if (selected != NO_NODE && nodes[selected].isSolved()) {
+            backProp(nodes[selected].getSolvedResult(), context, (int)leafPlayouts, true);
+            return;
+        }
+        if (termination->isTerminal(*context.pathStates.back())) {
+            // Every playout from a terminal state would end with the same score
+            backProp(scoring->score(*context.pathStates.back()), context, (int)leafPlayouts, solver);
+            return;
+        }
+
+        if (selected == NO_NODE)
+            selected = createEdgeNode(context);
+
+        /**
+         * Expansion
+         */
+        if (selected != NO_NODE && nodes[selected].getNumVisits() >= minT)
+            expandNext(selected, context);
+
+        /**
+         * Simulation
+         */
+        simulate(context);
+    }
+
+    /** Selects the best child node at the given node and returns its position in the node's children */
+    std::uint32_t select(const Node<T, A, E>& node, SearchContext& context)
+    {
+        auto& children = node.getChildren();
+
+        // Select randomly if the Node has not been visited often enough
+        if (node.getNumVisits() < minVisits) {
+            std::uniform_int_distribution<std::uint32_t> distribution(0, children.size() - 1);
+            std::uint32_t slot = distribution(context.generator);
+            if (!node.isChildSolved(slot))
+                return slot;
+        }
+
+        // Use the UCT formula for selection
+        auto logVisits = (float)log(node.getNumVisits());
+        if (usesHistory() || raveEquivalence > 0 || node.hasSolvedChildren())
+            return selectWithHeuristics(node, context, logVisits);
+        return UCT::select(node.getChildScoreSums().data(), node.getChildVisits().data(), children.size(), logVisits, C);
+    }
+
+    /** @return True if progressive history is enabled, see setW() */
+    bool usesHistory() const { return actionHash && W != 0.0F; }
+
+    /** Selects the child with the highest UCT value, blended with RAVE and plus the progressive history term, see
+     * setRave() and setW(). Proven children are skipped, see setSolver(). */
+    std::uint32_t selectWithHeuristics(const Node<T, A, E>& node, const SearchContext& context, float logVisits) const
+    {
+        const std::vector<int>& visits = node.getChildVisits();
+        const std::vector<float>& scoreSums = node.getChildScoreSums();
+        const std::vector<int>& amafVisits = node.getChildAmafVisits();
+        const std::vector<float>& amafScoreSums = node.getChildAmafScoreSums();
+        const std::vector<std::size_t>& hashes = node.getChildActionHashes();
+        auto k = (float)raveEquivalence;
+        auto best = (std::uint32_t)visits.size();
+        float bestValue = -std::numeric_limits<float>::infinity();
+
+        for (std::uint32_t i = 0; i < visits.size(); i++) {
+            if (node.isChildSolved(i))
+                continue;
+
+            int amafN = raveEquivalence > 0 && i < amafVisits.size() ? amafVisits[i] : 0;
+
+            // Children without any statistics come first, as with UCT alone
+            if (visits[i] == 0 && amafN == 0)
+                return i;
+
+            auto n = (float)visits[i];
+            float avgScore = visits[i] == 0 ? 0.0F : scoreSums[i] / n;
+            if (amafN > 0) {
+                float beta = std::sqrt(k / (3.0F * n + k));
+                avgScore = (1.0F - beta) * avgScore + beta * amafScoreSums[i] / (float)amafN;
+            }
+
+            // A child only known from RAVE is explored as if it had one visit
+            float value = avgScore + C * std::sqrt(logVisits / std::max(n, 1.0F));
+            if (usesHistory()) {
+                // RAVE keeps the hashes of the actions of the children
+                std::size_t hash = i < hashes.size() ? hashes[i] : actionHash->hash(childAction(node, i));
+                float history = context.history.getAvgScore(hash);
+                value += W * history / ((1.0F - avgScore) * n + 1.0F);
+            }
+            if (value > bestValue) {
+                bestValue = value;
+                best = i;
             }
         }
 
-        // If no expansion took place, simply execute a random action
-        if (!best) {
-            A action;
-            T state(root->getData());
-            auto playout = P(&state);
-            playout.generateRandom(action);
-            return action;
+        // Another thread proved every child after this node was checked
+        return best < visits.size() ? best : (std::uint32_t)bestSolvedChild(node);
+    }
+
+    /** @return The position of the proven child with the best score, the number of children if none is proven */
+    std::size_t bestSolvedChild(const Node<T, A, E>& node) const
+    {
+        const std::vector<float>& scores = node.getChildSolvedScores();
+        std::size_t best = node.getChildren().size();
+        for (std::size_t i = 0; i < scores.size(); i++) {
+            if (!std::isnan(scores[i]) && (best == node.getChildren().size() || scores[i] > scores[best]))
+                best = i;
+        }
+        return best;
+    }
+
+    /** Create the PlayoutStrategy of a thread, acting on the state of the thread */
+    void createPlayout(SearchContext& context, const T& state)
+    {
+        if (context.playoutState) {
+            *context.playoutState = state;
+        } else {
+            context.playoutState.reset(new T(state));
+            context.playout.reset(new P(context.playoutState.get()));
+        }
+    }
+
+    /** Start the working state of a thread at the root, for undoable actions */
+    void resetWorkingState(SearchContext& context)
+    {
+        createPlayout(context, nodes[root].getData());
+        context.undoActions.clear();
+    }
+
+    /** Find the state of every node on the path, rebuilding the states that are not stored */
+    void rebuildStates(SearchContext& context)
+    {
+        context.pathStates.clear();
+        for (std::size_t depth = 0; depth < context.path.size(); depth++)
+            pushPathState(context, depth);
+    }
+
+    /** Find the state of the node at the given depth of the path from the state of its parent */
+    void pushPathState(SearchContext& context, std::size_t depth)
+    {
+        NodeIndex node = context.path[depth].node;
+
+        // Walk the working state down the path, it is at the root at the start of an iteration
+        if (Undoable::value) {
+            T& working = *context.playoutState;
+            if (depth > 0) {
+                context.undoActions.push_back(pathAction(context, depth));
+                context.undoActions.back().execute(working);
+            }
+            context.pathStates.push_back(&working);
+        } else if (node != NO_NODE && nodes[node].hasData()) {
+            context.pathStates.push_back(nodes[node].getStoredData());
+        } else {
+            T& state = stateBuffer(context, depth, *context.pathStates[depth - 1]);
+            A(pathAction(context, depth)).execute(state);
+            context.pathStates.push_back(&state);
         }
+    }
+
+    /** @return The action leading to a child of the given node */
+    const A& childAction(const Node<T, A, E>& node, std::size_t slot) const
+    {
+        // A node shared with other parents holds the action of only one of them
+        return node.hasChildActions() ? node.getChildAction(slot) : nodes[node.getChildren()[slot]].getAction();
+    }
 
-        return best->getAction();
+    /** @return The action leading to the node at the given depth of the path */
+    const A& pathAction(const SearchContext& context, std::size_t depth) const
+    {
+        const Step& step = context.path[depth];
+        return step.parentAction ? context.pathActions[depth] : nodes[step.node].getAction();
     }
 
     /**
-     * Set the allowed computation time in milliseconds
-     * @param time In milliseconds
+     * Add the child at the given position of a node to the path of a thread.
+     * The node must be locked when several threads are searching.
      */
-    void setTime(int time) { this->allowedComputationTime = std::chrono::milliseconds(time); }
+    void pushStep(SearchContext& context, const Node<T, A, E>& node, std::uint32_t slot)
+    {
+        std::size_t depth = context.path.size();
+        bool parentAction = node.hasChildActions();
+        if (parentAction) {
+            if (context.pathActions.size() <= depth)
+                context.pathActions.resize(depth + 1);
+            context.pathActions[depth] = node.getChildAction(slot);
+        }
+        context.path.push_back({ node.getChildren()[slot], slot, parentAction });
+    }
 
     /**
-     * @brief Set the C parameter of the UCT formula
-     * @param newC The C parameter
+     * Add a child to a node, keeping its action in the node when the child's
+     * node holds another action. The node must be locked when several threads
+     * are searching.
+     *
+     * @param transposition True if child is an existing node found by addNode()
      */
-    void setC(float newC) { this->C = newC; }
+    void linkChild(Node<T, A, E>& node, NodeIndex child, A action, bool transposition)
+    {
+        if (transposition) {
+            node.storeChildActions(nodes);
+            node.addSharedChild(child, std::move(action));
+        } else {
+            node.addChild(child, action);
+        }
+    }
 
     /**
-     * @brief Set the minimal number of visits until a node is expanded
-     * @param newMinT the minimal number of visits
+     * Create the node of the child at the end of the path, which only exists
+     * as an edge, now that it is visited a second time.
+     *
+     * @return The index of the node, NO_NODE if there is no room for it
      */
-    void setMinT(float newMinT) { this->minT = newMinT; }
+    NodeIndex createEdgeNode(SearchContext& context)
+    {
+        std::size_t depth = context.path.size() - 1;
+        Step& step = context.path.back();
+        NodeIndex parentIndex = context.path[depth - 1].node;
+        Node<T, A, E>& parent = nodes[parentIndex];
+        std::unique_lock<Node<T, A, E>> guard(parent, std::defer_lock);
+        if (shared)
+            guard.lock();
+
+        // Another thread may have created the node since the edge was selected
+        NodeIndex child = parent.getChildren()[step.slot];
+        if (child == NO_NODE) {
+            if (!reserveNode(context))
+                return NO_NODE;
+            const T& state = *context.pathStates.back();
+            T* stored = storesState(depth) ? createState(state) : nullptr;
+            bool transposition = false;
+            child = addNode(stored, state, parentIndex, context.pathActions[depth], context, transposition);
+            parent.setChild(step.slot, child);
+        }
+
+        if (shared)
+            nodes[child].addVirtualLoss(virtualLoss);
+        step.node = child;
+        return child;
+    }
+
+    /** Copy a state into the buffer of the given depth of a thread and return the buffer */
+    static T& stateBuffer(SearchContext& context, std::size_t depth, const T& source)
+    {
+        if (context.stateBuffers.size() <= depth)
+            context.stateBuffers.resize(depth + 1);
+
+        std::unique_ptr<T>& buffer = context.stateBuffers[depth];
+        if (buffer)
+            *buffer = source;
+        else
+            buffer.reset(new T(source));
+        return *buffer;
+    }
+
+    /** @return True if a node at the given depth below the root stores its state */
+    bool storesState(std::size_t depth) const
+    {
+        return depth == 0 || stateStorage == StateStorage::FULL
+            || (stateStorage == StateStorage::CHECKPOINT && depth % checkpointInterval == 0);
+    }
+
+    /** Get the next Action for the given Node, execute and add the new Node to
+     * the tree. Returns the given node when no Node can be added and NO_NODE
+     * when the child is added as an edge. */
+    NodeIndex expandNext(NodeIndex index, SearchContext& context)
+    {
+        Node<T, A, E>& node = nodes[index];
+        std::unique_lock<Node<T, A, E>> guard(node, std::defer_lock);
+        if (shared)
+            guard.lock();
+
+        // The state is either stored in the node or rebuilt in a buffer of this thread
+        T& state = const_cast<T&>(*context.pathStates.back());
+        if (node.getExpansion() == Node<T, A, E>::NOT_EXPANDED) {
+            context.actions.clear();
+            if (ExpansionAccess<E, T, A>::generateAll(state, context.actions, 0))
+                return expandAll(index, state, context);
+            createExpansion(node, state);
+        }
+
+        // Another thread may have taken the last action since this node was selected
+        if (node.getExpansion() == Node<T, A, E>::FULLY_EXPANDED || (!lazyChildren && !reserveNode(context)))
+            return index;
+
+        E& expansion = expansions[node.getExpansion()];
+        ExpansionAccess<E, T, A>::setState(expansion, state);
+        A action = ExpansionAccess<E, T, A>::generateNext(expansion, state);
+        if (!ExpansionAccess<E, T, A>::canGenerateNext(expansion, state)) {
+            releaseExpansion(node);
+            // Keeps the solver from deciding the node while its last child is added
+            node.setAddingLastChild(true);
+        }
+        if (shared)
+            guard.unlock();
+
+        std::size_t depth = context.path.size();
+        // A child that only exists as an edge does not store its state
+        bool store = !lazyChildren && storesState(depth);
+        T* stored = nullptr;
+        T* expandedData;
+        if (Undoable::value) {
+            // The working state moves on to the new node
+            context.undoActions.push_back(action);
+            context.undoActions.back().execute(state);
+            expandedData = &state;
+            if (store)
+                stored = createState(state);
+        } else if (store) {
+            stored = createState(state);
+            expandedData = stored;
+            action.execute(*expandedData);
+        } else {
+            expandedData = &stateBuffer(context, depth, state);
+            action.execute(*expandedData);
+        }
+        NodeIndex newNode = NO_NODE;
+        if (lazyChildren) {
+            if (shared)
+                guard.lock();
+            node.storeChildActions(nodes);
+            node.addEdge(std::move(action));
+        } else {
+            bool transposition = false;
+            newNode = addNode(stored, *expandedData, index, action, context, transposition);
+            if (shared)
+                guard.lock();
+            linkChild(node, newNode, std::move(action), transposition);
+        }
+        node.setAddingLastChild(false);
+
+        auto slot = (std::uint32_t)node.getChildren().size() - 1;
+        if (shared) {
+            node.addChildVirtualLoss(slot, virtualLoss);
+            if (newNode != NO_NODE)
+                nodes[newNode].addVirtualLoss(virtualLoss);
+        }
+        pushStep(context, node, slot);
+        // A transposition has its own stored state
+        bool hasData = newNode != NO_NODE && nodes[newNode].hasData();
+        context.pathStates.push_back(hasData ? nodes[newNode].getStoredData() : expandedData);
+        return newNode;
+    }
 
     /**
-     * Set the minimum number of visits until UCT is used instead of random
-     * selection during the selection stage.
-     * @param newMinVisits The minimal number of visits
+     * Add a child for every action in the buffer of the thread at once and
+     * continue the iteration at the first one. The node must be locked when
+     * several threads are searching.
      */
-    void setMinVisits(int newMinVisits) { this->minVisits = newMinVisits; }
+    NodeIndex expandAll(NodeIndex index, T& state, SearchContext& context)
+    {
+        Node<T, A, E>& node = nodes[index];
+        node.setExpansion(Node<T, A, E>::FULLY_EXPANDED);
+        if (context.actions.empty())
+            return index;
+
+        std::size_t depth = context.path.size();
+        bool store = !lazyChildren && storesState(depth);
+        node.reserveChildren(context.actions.size(), lazyChildren);
+        for (A& action : context.actions) {
+            // Children that do not fit in the tree are added as edges
+            if (lazyChildren || !reserveNode(context)) {
+                node.storeChildActions(nodes);
+                node.addEdge(std::move(action));
+                continue;
+            }
+
+            T* stored = nullptr;
+            NodeIndex child;
+            bool transposition = false;
+            if (Undoable::value) {
+                A executed(action);
+                executed.execute(state);
+                if (store)
+                    stored = createState(state);
+                child = addNode(stored, state, index, action, context, transposition);
+                undo(executed, state, Undoable());
+            } else {
+                T* data = store ? createState(state) : &stateBuffer(context, depth, state);
+                stored = store ? data : nullptr;
+                action.execute(*data);
+                child = addNode(stored, *data, index, action, context, transposition);
+            }
+            linkChild(node, child, std::move(action), transposition);
+        }
+
+        NodeIndex first = node.getChildren()[0];
+        if (shared) {
+            node.addChildVirtualLoss(0, virtualLoss);
+            if (first != NO_NODE)
+                nodes[first].addVirtualLoss(virtualLoss);
+        }
+        pushStep(context, node, 0);
+        pushPathState(context, depth);
+        return first;
+    }
+
+    /** Store a copy of the given state in the pool of states */
+    T* createState(const T& state)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (shared)
+            lock = std::unique_lock<std::mutex>(shared->treeMutex);
+        return states.create(state);
+    }
+
+    /** Destroy the stored state of a node, if any */
+    void releaseState(Node<T, A, E>& node)
+    {
+        if (node.hasData()) {
+            states.destroy(states.indexOf(node.getStoredData()));
+            node.setData(nullptr);
+        }
+    }
+
+    /** Create the ExpansionStrategy of a node on its first expansion */
+    void createExpansion(Node<T, A, E>& node, T& state)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (shared)
+            lock = std::unique_lock<std::mutex>(shared->treeMutex);
+
+        std::uint32_t index = expansions.nextIndex();
+        const E& expansion = *expansions.create(ExpansionAccess<E, T, A>::create(state));
+        node.setExpansion(index);
+
+        if (!ExpansionAccess<E, T, A>::canGenerateNext(expansion, state)) {
+            expansions.destroy(index);
+            node.setExpansion(Node<T, A, E>::FULLY_EXPANDED);
+        }
+    }
+
+    /** Destroy the ExpansionStrategy of a node when it has generated all actions */
+    void releaseExpansion(Node<T, A, E>& node)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (shared)
+            lock = std::unique_lock<std::mutex>(shared->treeMutex);
+
+        expansions.destroy(node.getExpansion());
+        node.setExpansion(Node<T, A, E>::FULLY_EXPANDED);
+    }
 
     /**
-     * Set the minimum number of iterations required before calculateAction()
-     * returns.
-     *
-     * MCTS will go over time, set using setTime(int), if this number of
-     * iterations is not reached.
+     * Make sure a node can be added by expandNext() without exceeding maxNodes.
+     * With several threads, the node is counted until addNode() adds it.
      *
-     * @param minVisits The minimum number of iterations
+     * @return True if a node can be added
      */
-    void setMinIterations(int i) { this->minIterations = i; }
+    bool reserveNode(const SearchContext& context)
+    {
+        if (!shared)
+            return makeRoom(context);
+
+        std::lock_guard<std::mutex> lock(shared->treeMutex);
+        if (nodes.size() + shared->reserved >= maxNodes)
+            return false;
+        shared->reserved++;
+        return true;
+    }
 
     /**
-     * Get the root of the MCTS tree. Useful for printing.
-     * @see writeDotFile()
-     * @return The root of the MCTS tree
+     * Add a node with the given state to the tree, or find an existing node
+     * with the same state if transpositions are detected.
+     *
+     * @param stored The state of the new node if it stores its state, it is
+     * destroyed when an existing node is found
+     * @param data The state of the new node
+     * @param transposition Set to true if an existing node is found
+     * @return The index of the node
      */
-    Node<T, A, E>& getRoot() { return root; }
+    NodeIndex addNode(T* stored, const T& data, NodeIndex parent, const A& action, const SearchContext& context,
+        bool& transposition)
+    {
+        std::size_t hash = stateHash ? stateHash->hash(data) : 0;
+
+        std::unique_lock<std::mutex> lock;
+        if (shared) {
+            lock = std::unique_lock<std::mutex>(shared->treeMutex);
+            shared->reserved--;
+        }
+
+        NodeIndex newNode = NO_NODE;
+        if (stateHash)
+            newNode = findTransposition(hash, data, context.path);
+
+        transposition = newNode != NO_NODE;
+        if (!transposition) {
+            newNode = createNode(stored, parent, action);
+            if (stateHash)
+                transpositions.emplace(hash, newNode);
+        } else if (stored) {
+            states.destroy(states.indexOf(stored));
+        }
+        return newNode;
+    }
 
-    ~MCTS()
+    /**
+     * Find a node with the given state that is not on the given path, to keep
+     * the graph acyclic.
+     *
+     * @return The index of the node or NO_NODE if there is no such node
+     */
+    NodeIndex findTransposition(std::size_t hash, const T& state, const std::vector<Step>& path)
     {
-        delete backprop;
-        delete termination;
-        delete scoring;
+        auto range = transpositions.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (!stateHash->equals(nodes[it->second].getData(), state))
+                continue;
+
+            bool onPath = false;
+            for (const Step& step : path)
+                onPath = onPath || step.node == it->second;
+            if (!onPath)
+                return it->second;
+        }
+        return NO_NODE;
     }
 
-private:
-    void search()
+    /**
+     * Make the given node the root, moving its subtree to a new pool in breadth
+     * first order and releasing all other nodes.
+     */
+    void keepSubtree(NodeIndex newRoot)
     {
-        std::chrono::system_clock::time_point old = std::chrono::system_clock::now();
+        // The new index of a node is its position in order, which places siblings next to each other
+        std::vector<NodeIndex> newIndices(nodes.bound(), NO_NODE);
+        std::vector<NodeIndex> order { newRoot };
+        std::vector<NodeIndex> parents { NO_NODE };
+        newIndices[newRoot] = 0;
+
+        for (std::size_t i = 0; i < order.size(); i++) {
+            for (NodeIndex child : nodes[order[i]].getChildren()) {
+                if (child != NO_NODE && newIndices[child] == NO_NODE) {
+                    newIndices[child] = (NodeIndex)order.size();
+                    order.push_back(child);
+                    parents.push_back((NodeIndex)i);
+                }
+            }
+        }
+
+        // States stay in their pool, only the states of released nodes are destroyed
+        for (NodeIndex i = 0; i < nodes.bound(); i++) {
+            if (nodes.contains(i) && newIndices[i] == NO_NODE)
+                releaseState(nodes[i]);
+        }
+
+        // The ExpansionStrategies get their state passed again before they are used
+        ObjectPool<Node<T, A, E>> kept;
+        ObjectPool<E> keptExpansions;
+        for (std::size_t i = 0; i < order.size(); i++) {
+            Node<T, A, E>& node = *kept.create(std::move(nodes[order[i]]), (NodeIndex)i, parents[i], newIndices);
+            if (node.hasExpansion()) {
+                std::uint32_t index = keptExpansions.nextIndex();
+                keptExpansions.create(std::move(expansions[node.getExpansion()]));
+                node.setExpansion(index);
+            }
+        }
+
+        nodes = std::move(kept);
+        expansions = std::move(keptExpansions);
+        root = 0;
+
+        for (auto it = transpositions.begin(); it != transpositions.end();) {
+            if (newIndices[it->second] == NO_NODE) {
+                it = transpositions.erase(it);
+            } else {
+                it->second = newIndices[it->second];
+                ++it;
+            }
+        }
+    }
 
-        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - old) < allowedComputationTime || iterations < minIterations) {
-            iterations++;
+    /**
+     * Make sure a node can be added without exceeding maxNodes, evicting nodes
+     * if the policy allows it.
+     *
+     * @return True if a node can be added
+     */
+    bool makeRoom(const SearchContext& context)
+    {
+        if (nodes.size() < maxNodes)
+            return true;
+        if (memoryLimitPolicy == MemoryLimitPolicy::STOP_EXPANDING)
+            return false;
+
+        // Free a portion of the tree at once so eviction does not run every iteration
+        evict(maxNodes / 16 + 1, context.path);
+        return nodes.size() < maxNodes;
+    }
 
-            /**
-             * Selection
-             */
-            std::shared_ptr<Node<T, A, E>> selected = root;
-            while (!selected->shouldExpand())
-                selected = select(*selected);
+    /**
+     * Remove at least the given number of nodes by removing the children of the
+     * least valuable nodes that are not on the given path.
+     */
+    void evict(std::uint32_t needed, const std::vector<Step>& path)
+    {
+        std::vector<bool> onPath(nodes.bound(), false);
+        for (const Step& step : path) {
+            if (step.node != NO_NODE)
+                onPath[step.node] = true;
+        }
 
-            if (termination->isTerminal(selected->getData())) {
-                backProp(*selected, scoring->score(selected->getData()));
+        // Nodes with children, from least to most valuable
+        std::vector<std::pair<std::uint32_t, NodeIndex>> candidates;
+        for (NodeIndex i = 0; i < nodes.bound(); i++) {
+            if (!nodes.contains(i) || i == root || onPath[i] || nodes[i].getChildren().empty())
                 continue;
+            const Node<T, A, E>& node = nodes[i];
+            auto key = memoryLimitPolicy == MemoryLimitPolicy::EVICT_LEAST_VISITED ? (std::uint32_t)node.getNumVisits() : node.getLastVisit();
+            candidates.emplace_back(key, i);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        std::uint32_t target = nodes.size() > needed ? nodes.size() - needed : 0;
+        std::size_t batch = candidates.size() / 8 + 1;
+        std::size_t next = 0;
+        while (nodes.size() > target && next < candidates.size()) {
+            for (std::size_t end = std::min(next + batch, candidates.size()); next < end; next++) {
+                if (nodes.contains(candidates[next].second)) {
+                    Node<T, A, E>& node = nodes[candidates[next].second];
+                    if (node.hasExpansion())
+                        expansions.destroy(node.getExpansion());
+                    node.removeChildren();
+                }
             }
+            sweep();
+        }
+    }
 
-            /**
-             * Expansion
-             */
-            std::shared_ptr<Node<T, A, E>> expanded;
-            int numVisits = selected->getNumVisits();
-            if (numVisits >= minT) {
-                expanded = expandNext(selected);
-            } else {
-                expanded = selected;
+    /** Destroy all nodes that can no longer be reached from the root */
+    void sweep()
+    {
+        std::vector<bool> reachable(nodes.bound(), false);
+        std::vector<NodeIndex> stack { root };
+        reachable[root] = true;
+        while (!stack.empty()) {
+            NodeIndex current = stack.back();
+            stack.pop_back();
+            for (NodeIndex child : nodes[current].getChildren()) {
+                if (child != NO_NODE && !reachable[child]) {
+                    reachable[child] = true;
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        for (NodeIndex i = 0; i < nodes.bound(); i++) {
+            if (nodes.contains(i) && !reachable[i]) {
+                if (nodes[i].hasExpansion())
+                    expansions.destroy(nodes[i].getExpansion());
+                releaseState(nodes[i]);
+                nodes.destroy(i);
+                numEvicted++;
             }
+        }
 
-            /**
-             * Simulation
-             */
-            simulate(*expanded);
+        for (auto it = transpositions.begin(); it != transpositions.end();) {
+            if (nodes.contains(it->second))
+                ++it;
+            else
+                it = transpositions.erase(it);
         }
     }
 
-    /** Selects the best child node at the given node */
-    std::shared_ptr<Node<T, A, E>> select(const Node<T, A, E>& node)
+    /** Create a new Node in the pool and return its index */
+    NodeIndex createNode(T* data, NodeIndex parent, A action)
     {
-        std::shared_ptr<Node<T, A, E>> best = nullptr;
-        float bestScore = -std::numeric_limits<float>::max();
+        NodeIndex index = nodes.nextIndex();
+        nodes.create(index, data, parent, std::move(action));
+        return index;
+    }
 
-        auto& children = node.getChildren();
+    /** Simulate from the last node on the path until the stopping condition is reached. */
+    void simulate(SearchContext& context)
+    {
+        // Reuse the state and PlayoutStrategy of the previous playout on this thread, undoable
+        // actions continue on the working state, which is already at the last node
+        if (!Undoable::value)
+            createPlayout(context, *context.pathStates.back());
+        // The context may have moved since the last playout
+        bindGenerator(*context.playout, &context.generator, 0);
+
+        // The other playouts copy the leaf before the working state changes
+        if (leafPlayouts > 1)
+            prepareLeafPlayouts(context);
+
+        T* state = context.playoutState.get();
+        std::vector<A>* played = nullptr;
+        if (Undoable::value) {
+            // A rollout cannot be undone, so it plays on a copy of the working state
+            if (hasRollout(static_cast<P*>(nullptr), 0))
+                state = &stateBuffer(context, context.path.size(), *state);
+            else
+                played = &context.undoActions;
+        }
 
-        // Select randomly if the Node has not been visited often enough
-        if (node.getNumVisits() < minVisits) {
-            std::uniform_int_distribution<uint> distribution(0, children.size() - 1);
-            return children[distribution(generator)];
+        // Without undoable actions, the actions of the playout are only recorded for RAVE and progressive history
+        if ((raveEquivalence > 0 || usesHistory()) && !played) {
+            context.playoutActions.clear();
+            played = &context.playoutActions;
+        }
+        std::vector<Perspective>* perspectives = nullptr;
+        if (usesHistory()) {
+            context.playoutPerspectives.clear();
+            perspectives = &context.playoutPerspectives;
         }
 
-        // Use the UCT formula for selection
-        for (auto& n : children) {
-            float score = n->getAvgScore() + C * (float)sqrt(log(node.getNumVisits()) / n->getNumVisits());
+        std::size_t pathActions = context.undoActions.size();
+        float s = 0.0F;
+        // Only the actions of the playout on this thread are recorded
+        float recordedScore = 0.0F;
+        if (leafPlayouts > 1) {
+            threadPool->run(leafPlayouts, [this, &context, &s, state, played, perspectives](std::size_t i) {
+                if (i == 0) {
+                    s = playOut(*context.playout, *state, context.generator, played, perspectives, 0);
+                } else {
+                    LeafPlayout& leaf = context.leafPlayouts[i - 1];
+                    leaf.score = playOut(*leaf.playout, *leaf.state, leaf.generator, nullptr, nullptr, 0);
+                }
+            });
+
+            recordedScore = s;
+            for (const LeafPlayout& leaf : context.leafPlayouts)
+                s += leaf.score;
+            s /= (float)leafPlayouts;
+        } else {
+            s = playOut(*context.playout, *state, context.generator, played, perspectives, 0);
+            recordedScore = s;
+        }
 
-            if (score > bestScore) {
-                bestScore = score;
-                best = n;
+        if (raveEquivalence > 0 || usesHistory()) {
+            std::size_t first = played == &context.undoActions ? pathActions : 0;
+            for (std::size_t i = first; i < played->size(); i++) {
+                std::size_t hash = actionHash->hash((*played)[i]);
+                if (raveEquivalence > 0)
+                    context.amafActions.push_back(hash);
+                // A rollout reports no actions, so played and perspectives have the same length
+                if (usesHistory())
+                    context.history.update(hash, context.playoutPerspectives[i - first].of(recordedScore), 1);
             }
         }
 
-        return best;
+        // Return the working state to the last node on the path
+        while (context.undoActions.size() > pathActions)
+            undoLast(context);
+
+        backProp(s, context, (int)leafPlayouts);
     }
-    /** Get the next Action for the given Node, execute and add the new Node to
-     * the tree. */
-    std::shared_ptr<Node<T, A, E>> expandNext(const std::shared_ptr<Node<T, A, E>>& node)
-    {
-        T expandedData(node->getData());
-        auto action = node->generateNextAction();
-        action.execute(expandedData);
-        auto newNode = std::make_shared<Node<T, A, E>>(++currentNodeID, expandedData, node, action);
-        node->addChild(newNode);
-        return newNode;
+
+    /** Start the extra playouts of a thread at the last node on the path */
+    void prepareLeafPlayouts(SearchContext& context)
+    {
+        const T& leafState = *context.pathStates.back();
+        context.leafPlayouts.resize(leafPlayouts - 1);
+        for (LeafPlayout& leaf : context.leafPlayouts) {
+            if (leaf.state) {
+                *leaf.state = leafState;
+            } else {
+                leaf.generator.seed(context.generator());
+                leaf.state.reset(new T(leafState));
+                leaf.playout.reset(new P(leaf.state.get()));
+            }
+            bindGenerator(*leaf.playout, &leaf.generator, 0);
+        }
+    }
+
+    /** Undo the last action executed on the working state of a thread */
+    void undoLast(SearchContext& context)
+    {
+        undo(context.undoActions.back(), *context.playoutState, Undoable());
+        context.undoActions.pop_back();
+    }
+
+    static void undo(A& action, T& state, std::true_type) { action.undo(state); }
+
+    static void undo(A& /* action */, T& /* state */, std::false_type) { }
+
+    /** Give the PlayoutStrategy the random generator of a thread, chosen when P accepts one */
+    template <class Q>
+    static auto bindGenerator(Q& playout, std::mt19937* rng, int) -> decltype(playout.setRandomGenerator(rng))
+    {
+        playout.setRandomGenerator(rng);
+    }
+
+    /** PlayoutStrategies without setRandomGenerator() use their own generator */
+    static void bindGenerator(P& /* playout */, std::mt19937* /* rng */, long) { }
+
+    /** @return True, P implements rollout() */
+    template <class Q>
+    static constexpr auto hasRollout(Q* playout, int) -> decltype((void)playout->rollout(std::declval<T&>(), std::declval<std::mt19937&>()), true)
+    {
+        return true;
     }
 
-    /** Simulate until the stopping condition is reached. */
-    void simulate(Node<T, A, E>& node)
+    static constexpr bool hasRollout(P* /* playout */, long) { return false; }
+
+    /** Play until the end of the game using P::rollout(), chosen when P implements it */
+    template <class Q>
+    auto playOut(Q& playout, T& state, std::mt19937& rng, std::vector<A>* /* played */,
+        std::vector<Perspective>* /* perspectives */, int) -> decltype((float)playout.rollout(state, rng))
     {
-        T state(node.getData());
+        return (float)playout.rollout(state, rng);
+    }
 
+    /**
+     * Play until the end of the game one random action at a time, appending
+     * the actions to played and their Perspective to perspectives if they are
+     * set
+     */
+    float playOut(P& playout, T& state, std::mt19937& /* rng */, std::vector<A>* played,
+        std::vector<Perspective>* perspectives, long)
+    {
         A action;
         // Check if the end of the game is reached and generate the next state if
         // not
         while (!termination->isTerminal(state)) {
-            P playout(&state);
             playout.generateRandom(action);
             action.execute(state);
+            if (played)
+                played->push_back(action);
+            if (perspectives)
+                perspectives->push_back({ backprop->updateScore(state, 0.0F), backprop->updateScore(state, 1.0F) });
         }
 
         // Score the leaf node (end of the game)
-        float s = scoring->score(state);
+        return scoring->score(state);
+    }
 
-        backProp(node, s);
+    /**
+     * Credit every child of the given node whose action was played below it in
+     * the current iteration with the score of the iteration. The children
+     * share the perspective of the child on the path, whose score is given.
+     */
+    void updateAmaf(Node<T, A, E>& node, const SearchContext& context, float score, int visits)
+    {
+        // Every child's action is hashed once, by the first update after the child was added
+        const std::size_t numChildren = node.getChildren().size();
+        for (std::size_t slot = node.getChildActionHashes().size(); slot < numChildren; slot++)
+            node.addChildActionHash(actionHash->hash(childAction(node, slot)));
+
+        const std::vector<std::size_t>& hashes = node.getChildActionHashes();
+        for (std::size_t slot = 0; slot < numChildren; slot++) {
+            if (std::binary_search(context.amafActions.begin(), context.amafActions.end(), hashes[slot]))
+                node.updateChildAmaf(slot, score, visits);
+        }
     }
 
-    /** Backpropagate a score through the tree */
-    void backProp(Node<T, A, E>& node, float score)
+    /**
+     * Record that a child of the given node is proven, and prove the node
+     * itself when the child is a win or all its children are proven. The node
+     * must be locked when several threads are searching.
+     *
+     * @param result Set to the proven result of the node
+     * @return True if the node is proven
+     */
+    bool solveChild(Node<T, A, E>& node, std::uint32_t slot, float score, float childResult, float& result)
     {
-        node.update(backprop->updateScore(node.getData(), score));
+        node.setChildSolved(slot, score, childResult);
+
+        // The player choosing at the node takes a proven win
+        if (score >= WIN_SCORE) {
+            result = childResult;
+            return true;
+        }
+
+        if (!node.hasAllChildren())
+            return false;
+        const std::vector<float>& scores = node.getChildSolvedScores();
+        if (scores.size() < node.getChildren().size())
+            return false;
+        for (float childScore : scores) {
+            if (std::isnan(childScore))
+                return false;
+        }
+
+        result = node.getChildSolvedResults()[bestSolvedChild(node)];
+        return true;
+    }
 
-        std::shared_ptr<Node<T, A, E>> current = node.getParent();
-        while (current) {
-            current->update(backprop->updateScore(current->getData(), score));
-            current = current->getParent();
+    /** Backpropagate the average score of the given number of playouts through
+     * the nodes on the path of the current iteration, removing the virtual loss
+     * added during selection. When proven is true, score is the proven result
+     * of the last node on the path, see setSolver(). */
+    void backProp(float score, SearchContext& context, int visits = 1, bool proven = false)
+    {
+        const std::vector<Step>& path = context.path;
+
+        // The proven result of the node at the current depth, only while proven is true
+        float solvedResult = score;
+
+        // Eviction is single threaded, so only a single thread needs the visit times
+        if (!shared)
+            visitClock++;
+
+        // The playout adds its actions in the order they were played
+        if (raveEquivalence > 0)
+            std::sort(context.amafActions.begin(), context.amafActions.end());
+
+        for (std::size_t i = path.size(); i-- > 0;) {
+            // A child without a node only has the statistics of its edge
+            Node<T, A, E>* n = path[i].node != NO_NODE ? &nodes[path[i].node] : nullptr;
+            float updated = backprop->updateScore(*context.pathStates[i], score);
+            int loss = shared && i > 0 ? virtualLoss : 0;
+            if (n && shared) {
+                n->updateConcurrent(updated * visits, loss, visits);
+            } else if (n) {
+                n->update(updated * visits, visits);
+                n->touch(visitClock);
+            }
+            if (n && proven)
+                n->setSolvedResult(solvedResult);
+
+            if (i > 0) {
+                std::size_t actionHashValue = actionHash ? actionHash->hash(pathAction(context, i)) : 0;
+                if (usesHistory())
+                    context.history.update(actionHashValue, updated * visits, visits);
+                // Kept sorted, the path adds one action per level
+                if (raveEquivalence > 0) {
+                    auto position = std::upper_bound(context.amafActions.begin(), context.amafActions.end(), actionHashValue);
+                    context.amafActions.insert(position, actionHashValue);
+                }
+
+                Node<T, A, E>& parent = nodes[path[i - 1].node];
+                std::unique_lock<Node<T, A, E>> guard(parent, std::defer_lock);
+                if (shared)
+                    guard.lock();
+                parent.updateChild(path[i].slot, updated * visits, loss, visits);
+                if (raveEquivalence > 0)
+                    updateAmaf(parent, context, updated * visits, visits);
+                if (proven) {
+                    float provenScore = backprop->updateScore(*context.pathStates[i], solvedResult);
+                    proven = solveChild(parent, path[i].slot, provenScore, solvedResult, solvedResult);
+                }
+                if (n && stateHash && transpositionBackup == TranspositionBackup::NODE)
+                    parent.setChildAvgScore(path[i].slot, n->getAvgScore());
+
+                // Move the working state up to the parent
+                if (Undoable::value)
+                    undoLast(context);
+            }
         }
     }
 };
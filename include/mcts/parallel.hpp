@@ -0,0 +1,192 @@
+#ifndef CPP_MCTS_PARALLEL_HPP
+#define CPP_MCTS_PARALLEL_HPP
+
+#include "mcts.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Root parallel MCTS, searching several independent trees at once
+ *
+ * Every thread searches its own MCTS instance, created by a user supplied
+ * factory so each tree has its own Backpropagation, TerminationCheck and
+ * Scoring. Each tree is seeded differently so the trees explore different
+ * parts of the game. When the search ends, the visits and scores of the root
+ * actions of all trees are added up and the action with the best average score
+ * is chosen.
+ *
+ * The trees are searched by the workers of a ThreadPool, which is created
+ * once and kept across searches, see setThreadPool().
+ *
+ * @tparam T The State type this MCTS operates on
+ * @tparam A The Action type this MCTS operates on, must implement operator==
+ * @tparam E The ExpansionStrategy this MCTS uses
+ * @tparam P The PlayoutStrategy this MCTS uses
+ * @tparam B The Backpropagation this MCTS uses
+ * @tparam TC The TerminationCheck this MCTS uses
+ * @tparam S The Scoring this MCTS uses
+ */
+template <class T, class A, class E, class P, class B = Backpropagation<T>, class TC = TerminationCheck<T>,
+    class S = Scoring<T>>
+class RootParallelMCTS {
+public:
+    /** The type of the tree searched by each thread */
+    using Tree = MCTS<T, A, E, P, B, TC, S>;
+
+    /** Creates the tree for one thread, searching from the given root state */
+    using Factory = std::function<Tree(const T& rootData)>;
+
+private:
+    std::vector<Tree> trees;
+
+    std::shared_ptr<ThreadPool> threadPool;
+
+public:
+    /**
+     * @param rootData The state to search from
+     * @param numThreads The number of trees and threads, at least 1
+     * @param factory Creates the tree for each thread
+     * @param seed The seed of the first tree, tree i is seeded with seed + i
+     */
+    RootParallelMCTS(const T& rootData, unsigned int numThreads, const Factory& factory, unsigned int seed = 0)
+        : threadPool(std::make_shared<ThreadPool>(std::max(numThreads, 1U) - 1))
+    {
+        trees.reserve(numThreads);
+        for (unsigned int i = 0; i < numThreads; i++) {
+            trees.push_back(factory(rootData));
+            trees.back().setSeed(seed + i);
+        }
+    }
+
+    /**
+     * @brief Search all trees in parallel and choose the best Action
+     *
+     * A tree that proved the outcome of the root (see MCTS::setSolver()) decides
+     * on its own, as the averages of the other trees cannot improve on a proof.
+     *
+     * @return The proven best Action if any tree proved the root, otherwise the
+     * Action with the best average score over all trees
+     */
+    A calculateAction()
+    {
+        search();
+
+        for (auto& tree : trees) {
+            if (tree.isSolved())
+                return tree.getBestAction();
+        }
+
+        // Actions without visits, e.g. created by expandAll, have no average
+        auto statistics = getRootStatistics();
+        const ActionStatistics<A>* best = nullptr;
+        for (const auto& entry : statistics) {
+            if (entry.numVisits == 0)
+                continue;
+            if (!best || entry.scoreSum / entry.numVisits > best->scoreSum / best->numVisits)
+                best = &entry;
+        }
+        if (!best)
+            return trees[0].getBestAction();
+        return best->action;
+    }
+
+    /**
+     * @brief Search all trees in parallel, one thread per tree
+     *
+     * The calling thread searches one of the trees.
+     */
+    void search()
+    {
+        threadPool->run(trees.size(), [this](std::size_t i) { trees[i].search(); });
+    }
+
+    /**
+     * @return The visits and score sums of all root actions, added up over all
+     * trees
+     */
+    std::vector<ActionStatistics<A>> getRootStatistics() const
+    {
+        std::vector<ActionStatistics<A>> merged;
+        for (const auto& tree : trees) {
+            for (const auto& entry : tree.getRootStatistics()) {
+                auto it = std::find_if(merged.begin(), merged.end(),
+                    [&entry](const ActionStatistics<A>& m) { return m.action == entry.action; });
+                if (it == merged.end()) {
+                    merged.push_back(entry);
+                } else {
+                    it->numVisits += entry.numVisits;
+                    it->scoreSum += entry.scoreSum;
+                }
+            }
+        }
+        return merged;
+    }
+
+    /**
+     * @brief Move the root of every tree along a played action
+     * @see MCTS::advance()
+     */
+    void advance(const A& action)
+    {
+        for (auto& tree : trees)
+            tree.advance(action);
+    }
+
+    /**
+     * Set the allowed computation time of every tree in milliseconds
+     * @param time In milliseconds
+     */
+    void setTime(int time)
+    {
+        for (auto& tree : trees)
+            tree.setTime(time);
+    }
+
+    /**
+     * Set the minimum number of iterations of every tree
+     * @see MCTS::setMinIterations()
+     */
+    void setMinIterations(int i)
+    {
+        for (auto& tree : trees)
+            tree.setMinIterations(i);
+    }
+
+    /**
+     * @return The number of iterations of the last search, added up over all
+     * trees
+     */
+    unsigned long long getIterations() const
+    {
+        unsigned long long total = 0;
+        for (const auto& tree : trees)
+            total += tree.getIterations();
+        return total;
+    }
+
+    /**
+     * @brief Set the pool whose workers search the trees
+     *
+     * The pool may be shared with other searches. With fewer than
+     * getNumThreads() - 1 workers, some trees are searched one after another.
+     *
+     * @param pool The pool to use, must not be nullptr
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> pool) { this->threadPool = std::move(pool); }
+
+    /**
+     * @return The number of trees, which is the number of threads
+     */
+    std::size_t getNumThreads() const { return trees.size(); }
+
+    /**
+     * @param i The index of the tree, less than getNumThreads()
+     * @return The tree searched by thread i, e.g. to configure it
+     */
+    Tree& getTree(std::size_t i) { return trees[i]; }
+};
+
+#endif // CPP_MCTS_PARALLEL_HPP
@@ -0,0 +1,226 @@
+#ifndef CPP_MCTS_POOL_HPP
+#define CPP_MCTS_POOL_HPP
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Arena storing objects in a small number of large chunks
+ *
+ * Objects are constructed in place in chunks that double in size every time the
+ * pool runs out of space, starting with 2^FIRST_CHUNK_BITS objects. Objects never
+ * move once constructed, so pointers to them stay valid until clear() or reset()
+ * is called or the pool is destroyed. Releasing the pool frees one block of memory per
+ * chunk instead of one per object.
+ *
+ * Objects are numbered in order of creation and can be looked up by that
+ * 32-bit index, which makes the pool usable as a contiguous-per-chunk container.
+ * Single objects can be destroyed with destroy(), their index and memory are
+ * then reused by the next objects created.
+ *
+ * @tparam O The type of object stored in this pool
+ */
+template <class O>
+class ObjectPool {
+    /** The first chunk holds 2^FIRST_CHUNK_BITS objects */
+    static constexpr unsigned int FIRST_CHUNK_BITS = 8;
+
+    /** Enough chunks to address 2^32 objects */
+    static constexpr unsigned int MAX_CHUNKS = 32 - FIRST_CHUNK_BITS + 1;
+
+    using Storage = typename std::aligned_storage<sizeof(O), alignof(O)>::type;
+
+    Storage* chunks[MAX_CHUNKS] = {};
+
+    /** The number of slots ever used, every index below count is either alive or free */
+    std::uint32_t count = 0;
+
+    /** Indices of destroyed objects, reused before new slots */
+    std::vector<std::uint32_t> freeList;
+
+    /** Marks destroyed objects, empty when no object was destroyed since the last clear() */
+    std::vector<bool> freed;
+
+public:
+    ObjectPool() = default;
+
+    ObjectPool(const ObjectPool& other) = delete;
+    ObjectPool& operator=(const ObjectPool& other) = delete;
+
+    ObjectPool(ObjectPool&& other) noexcept { swap(other); }
+
+    ObjectPool& operator=(ObjectPool&& other) noexcept
+    {
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    ~ObjectPool() { clear(); }
+
+    /**
+     * @brief Construct a new object at index nextIndex()
+     *
+     * @param args The arguments passed to the constructor of O
+     * @return A pointer to the new object, valid until the object is destroyed
+     */
+    template <class... Args>
+    O* create(Args&&... args)
+    {
+        if (!freeList.empty()) {
+            std::uint32_t index = freeList.back();
+            O* object = new (get(index)) O(std::forward<Args>(args)...);
+            freeList.pop_back();
+            freed[index] = false;
+            return object;
+        }
+
+        unsigned int chunk;
+        std::uint32_t offset;
+        locate(count, chunk, offset);
+
+        if (!chunks[chunk])
+            chunks[chunk] = static_cast<Storage*>(::operator new(sizeof(Storage) * chunkSize(chunk)));
+
+        O* object = new (&chunks[chunk][offset]) O(std::forward<Args>(args)...);
+        count++;
+        return object;
+    }
+
+    /**
+     * @return The index the next call to create() will construct an object at
+     */
+    std::uint32_t nextIndex() const { return freeList.empty() ? count : freeList.back(); }
+
+    /**
+     * @brief Destroy a single object, its index will be reused
+     * @param index The index of a live object
+     */
+    void destroy(std::uint32_t index)
+    {
+        get(index)->~O();
+        if (freed.size() < count)
+            freed.resize(count, false);
+        freed[index] = true;
+        freeList.push_back(index);
+    }
+
+    /**
+     * @param object An object created by this pool
+     * @return The index of the object, bound() if it is not in this pool
+     */
+    std::uint32_t indexOf(const O* object) const
+    {
+        auto address = reinterpret_cast<std::uintptr_t>(object);
+        for (unsigned int chunk = 0; chunk < MAX_CHUNKS && chunks[chunk]; chunk++) {
+            auto begin = reinterpret_cast<std::uintptr_t>(chunks[chunk]);
+            if (address >= begin && address < begin + sizeof(Storage) * chunkSize(chunk))
+                return (((1U << chunk) - 1) << FIRST_CHUNK_BITS) + (std::uint32_t)((address - begin) / sizeof(Storage));
+        }
+        return count;
+    }
+
+    /**
+     * @return True if index refers to a live object
+     */
+    bool contains(std::uint32_t index) const { return index < count && (index >= freed.size() || !freed[index]); }
+
+    /**
+     * @param index The position of the object in order of creation
+     * @return The object at the given index, which must be alive
+     */
+    O& operator[](std::uint32_t index) { return *get(index); }
+
+    /**
+     * @param index The position of the object in order of creation
+     * @return The object at the given index, which must be alive
+     */
+    const O& operator[](std::uint32_t index) const { return *get(index); }
+
+    /**
+     * @return The number of live objects in this pool
+     */
+    std::uint32_t size() const { return count - (std::uint32_t)freeList.size(); }
+
+    /**
+     * @return One past the highest index ever used, all live objects have a
+     * lower index
+     */
+    std::uint32_t bound() const { return count; }
+
+    /**
+     * @brief Destroy all objects and release all chunks
+     */
+    void clear()
+    {
+        reset();
+
+        for (auto& chunk : chunks) {
+            ::operator delete(chunk);
+            chunk = nullptr;
+        }
+    }
+
+    /**
+     * @brief Destroy all objects but keep the chunks, so the next objects are
+     * created without allocating memory until the pool outgrows them
+     */
+    void reset()
+    {
+        if (!std::is_trivially_destructible<O>::value) {
+            for (std::uint32_t i = 0; i < count; i++) {
+                if (contains(i))
+                    get(i)->~O();
+            }
+        }
+
+        count = 0;
+        freeList.clear();
+        freed.clear();
+    }
+
+    void swap(ObjectPool& other) noexcept
+    {
+        for (unsigned int i = 0; i < MAX_CHUNKS; i++)
+            std::swap(chunks[i], other.chunks[i]);
+        std::swap(count, other.count);
+        freeList.swap(other.freeList);
+        freed.swap(other.freed);
+    }
+
+private:
+    static std::uint32_t chunkSize(unsigned int chunk) { return 1U << (FIRST_CHUNK_BITS + chunk); }
+
+    /** Find the chunk and the offset in that chunk of the object at the given position */
+    static void locate(std::uint32_t index, unsigned int& chunk, std::uint32_t& offset)
+    {
+        chunk = log2((index >> FIRST_CHUNK_BITS) + 1);
+        offset = index - (((1U << chunk) - 1) << FIRST_CHUNK_BITS);
+    }
+
+    /** @return The index of the highest set bit of x, x must not be 0 */
+    static unsigned int log2(std::uint32_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 31U - static_cast<unsigned int>(__builtin_clz(x));
+#else
+        unsigned int result = 0;
+        while (x >>= 1U)
+            result++;
+        return result;
+#endif
+    }
+
+    O* get(std::uint32_t index) const
+    {
+        unsigned int chunk;
+        std::uint32_t offset;
+        locate(index, chunk, offset);
+        return reinterpret_cast<O*>(&chunks[chunk][offset]);
+    }
+};
+
+#endif // CPP_MCTS_POOL_HPP
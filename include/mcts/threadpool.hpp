@@ -0,0 +1,314 @@
+#ifndef CPP_MCTS_THREADPOOL_HPP
+#define CPP_MCTS_THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief How busy a worker of a ThreadPool was since the statistics were reset
+ */
+struct WorkerStatistics {
+    /** The number of tasks the worker ran */
+    std::uint64_t tasks;
+    /** The number of those tasks taken from the queue of another worker */
+    std::uint64_t stolen;
+    /** The time the worker spent running tasks */
+    std::chrono::nanoseconds busy;
+    /** The fraction of the time since the reset the worker spent running tasks */
+    double utilization;
+};
+
+/**
+ * @brief A fixed set of worker threads running tasks for MCTS
+ *
+ * The workers are started when the pool is created and wait for tasks until
+ * the pool is destroyed, so a search does not pay for creating threads. A pool
+ * can be shared by several MCTS instances.
+ *
+ * Every worker has its own queue of tasks. Tasks submitted by a worker are
+ * added to its own queue and run most recent first, which keeps their data in
+ * the worker's cache. Tasks submitted by other threads are spread over the
+ * queues. A worker with an empty queue steals the oldest task of another
+ * worker.
+ */
+class ThreadPool {
+    using Clock = std::chrono::steady_clock;
+
+    struct Worker {
+        std::thread thread;
+        /** Guards tasks */
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+
+        std::atomic<std::uint64_t> executed { 0 };
+        std::atomic<std::uint64_t> stolen { 0 };
+        std::atomic<std::int64_t> busyNanoseconds { 0 };
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /** The queue the next task from outside the pool is added to */
+    std::atomic<std::size_t> nextQueue { 0 };
+
+    /** The number of tasks in all queues */
+    std::atomic<std::size_t> pending { 0 };
+
+    /** Guards stopping and lets idle workers sleep */
+    std::mutex sleepMutex;
+
+    /** Signalled when a task is added or the pool stops */
+    std::condition_variable available;
+
+    /** Set when the pool is destroyed */
+    bool stopping = false;
+
+    /** When the statistics were last reset */
+    std::atomic<Clock::rep> statisticsStart;
+
+public:
+    /**
+     * @param numWorkers The number of worker threads
+     * @param pinWorkers Pin worker i to CPU i, modulo the number of CPUs. Only
+     * supported on Linux, ignored elsewhere.
+     */
+    explicit ThreadPool(unsigned int numWorkers, bool pinWorkers = false)
+        : statisticsStart(Clock::now().time_since_epoch().count())
+    {
+        workers.reserve(numWorkers);
+        for (unsigned int i = 0; i < numWorkers; i++)
+            workers.emplace_back(new Worker());
+
+        // Start the workers once all queues exist, they steal from each other
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            workers[i]->thread = std::thread(&ThreadPool::work, this, i);
+            if (pinWorkers)
+                pin(workers[i]->thread, i);
+        }
+    }
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    /**
+     * @brief Run the tasks that were already submitted and stop the workers
+     */
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers)
+            worker->thread.join();
+    }
+
+    /**
+     * @brief Run a task on one of the workers
+     *
+     * A pool without workers runs the task right away on the calling thread.
+     *
+     * @param task The task to run
+     */
+    void submit(std::function<void()> task)
+    {
+        if (workers.empty()) {
+            task();
+            return;
+        }
+
+        const std::pair<const ThreadPool*, std::size_t>& self = currentWorker();
+        std::size_t queue = self.first == this ? self.second : nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+        // Counted before it is queued, so taking it never makes pending wrap around
+        pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(workers[queue]->mutex);
+            workers[queue]->tasks.push_back(std::move(task));
+        }
+
+        // Taking the lock orders the new task before the check of a worker going to sleep
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        available.notify_one();
+    }
+
+    /**
+     * @brief Call task(i) for every i in [0, n) and wait until all calls are done
+     *
+     * The calling thread runs calls as well, so a pool without idle workers
+     * does not block it, even when it is called from one of the workers.
+     *
+     * @param n The number of calls
+     * @param task Called with the index of each call, from several threads at once
+     */
+    template <class F>
+    void run(std::size_t n, const F& task)
+    {
+        if (n == 0)
+            return;
+
+        // Workers may pick up a helper after the batch is done, so it outlives this call
+        auto batch = std::make_shared<Batch<F>>(task, n);
+        std::size_t helpers = std::min(n - 1, workers.size());
+        for (std::size_t i = 0; i < helpers; i++)
+            submit([batch]() { batch->work(); });
+
+        batch->work();
+
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&batch]() { return batch->done.load() == batch->n; });
+    }
+
+    /**
+     * @return The number of worker threads
+     */
+    std::size_t getNumWorkers() const { return workers.size(); }
+
+    /**
+     * @return The statistics of every worker since the pool was created or
+     * resetStatistics() was called
+     */
+    std::vector<WorkerStatistics> getWorkerStatistics() const
+    {
+        Clock::duration elapsed = Clock::now().time_since_epoch() - Clock::duration(statisticsStart.load());
+        auto elapsedNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+        std::vector<WorkerStatistics> statistics;
+        for (const auto& worker : workers) {
+            std::chrono::nanoseconds busy(worker->busyNanoseconds.load(std::memory_order_relaxed));
+            statistics.push_back({ worker->executed.load(std::memory_order_relaxed),
+                worker->stolen.load(std::memory_order_relaxed), busy,
+                elapsedNanoseconds > 0 ? std::min(1.0, (double)busy.count() / elapsedNanoseconds) : 0.0 });
+        }
+        return statistics;
+    }
+
+    /**
+     * @brief Start counting the statistics of every worker from zero
+     */
+    void resetStatistics()
+    {
+        for (auto& worker : workers) {
+            worker->executed = 0;
+            worker->stolen = 0;
+            worker->busyNanoseconds = 0;
+        }
+        statisticsStart = Clock::now().time_since_epoch().count();
+    }
+
+private:
+    /** The calls of one run(), taken by index by every thread that helps */
+    template <class F>
+    struct Batch {
+        const F* task;
+        std::size_t n;
+        std::atomic<std::size_t> next { 0 };
+        std::atomic<std::size_t> done { 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        Batch(const F& task, std::size_t n)
+            : task(&task)
+            , n(n)
+        {
+        }
+
+        void work()
+        {
+            for (std::size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+                (*task)(i);
+                if (done.fetch_add(1) + 1 == n) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    /** @return The pool and index of the worker running on the calling thread, nullptr if it is not a worker */
+    static std::pair<const ThreadPool*, std::size_t>& currentWorker()
+    {
+        static thread_local std::pair<const ThreadPool*, std::size_t> worker { nullptr, 0 };
+        return worker;
+    }
+
+    static void pin(std::thread& thread, std::size_t index)
+    {
+#if defined(__linux__)
+        unsigned int numCPUs = std::max(std::thread::hardware_concurrency(), 1U);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % numCPUs, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)index;
+#endif
+    }
+
+    /** Take the newest task of the given worker, or the oldest task of another worker */
+    bool take(std::size_t index, std::function<void()>& task)
+    {
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            Worker& victim = *workers[(index + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty())
+                continue;
+
+            if (i == 0) {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+            } else {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                workers[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            pending.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t index)
+    {
+        currentWorker() = { this, index };
+        Worker& self = *workers[index];
+
+        while (true) {
+            std::function<void()> task;
+            if (take(index, task)) {
+                Clock::time_point start = Clock::now();
+                task();
+                auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+                self.busyNanoseconds.fetch_add(busy.count(), std::memory_order_relaxed);
+                self.executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            available.wait(lock, [this]() { return stopping || pending.load() > 0; });
+            if (stopping && pending.load() == 0)
+                return;
+        }
+    }
+};
+
+#endif // CPP_MCTS_THREADPOOL_HPP
@@ -0,0 +1,207 @@
+#ifndef CPP_MCTS_UCT_HPP
+#define CPP_MCTS_UCT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPP_MCTS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(CPP_MCTS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CPP_MCTS_AVX2_DISPATCH
+#endif
+
+/**
+ * @brief Kernels computing the UCT formula for all children of a node at once
+ *
+ * The children of a Node keep their visit counts and score sums in two
+ * contiguous arrays. The kernels in this class read both arrays in one pass and
+ * return the child with the highest UCT value
+ *
+ *     scoreSum / visits + C * sqrt(ln(parentVisits) / visits)
+ *
+ * Children that have not been visited get an infinite value. When several
+ * children share the highest value, the first one is returned.
+ *
+ * The best kernel available on the running CPU (AVX2, SSE2 or scalar) is chosen
+ * the first time UCT::select() is called.
+ */
+class UCT {
+public:
+    using Kernel = std::size_t (*)(const float* scoreSums, const int* visits, std::size_t n, float logParentVisits, float c);
+
+    /**
+     * @brief Find the child with the highest UCT value
+     *
+     * @param scoreSums The sum of all scores of each child
+     * @param visits The number of visits of each child
+     * @param n The number of children, must be at least 1
+     * @param logParentVisits The natural logarithm of the number of visits of the parent
+     * @param c The C parameter of the UCT formula
+     * @return The index of the best child
+     */
+    static std::size_t select(const float* scoreSums, const int* visits, std::size_t n, float logParentVisits, float c)
+    {
+        static const Kernel kernel = detectKernel();
+        return kernel(scoreSums, visits, n, logParentVisits, c);
+    }
+
+    /**
+     * @return The fastest kernel supported by the running CPU
+     */
+    static Kernel detectKernel()
+    {
+#if defined(CPP_MCTS_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2"))
+            return selectAVX2;
+#endif
+#if defined(CPP_MCTS_X86)
+        return selectSSE2;
+#else
+        return selectScalar;
+#endif
+    }
+
+    /** Reference implementation, used on CPUs without a vector kernel */
+    static std::size_t selectScalar(const float* scoreSums, const int* visits, std::size_t n, float logParentVisits, float c)
+    {
+        std::size_t best = 0;
+        float bestScore = -std::numeric_limits<float>::infinity();
+
+        for (std::size_t i = 0; i < n; i++) {
+            float score = value(scoreSums[i], visits[i], logParentVisits, c);
+            if (score > bestScore) {
+                bestScore = score;
+                best = i;
+            }
+        }
+
+        return best;
+    }
+
+#if defined(CPP_MCTS_X86)
+    static std::size_t selectSSE2(const float* scoreSums, const int* visits, std::size_t n, float logParentVisits, float c)
+    {
+        const __m128 logN = _mm_set1_ps(logParentVisits);
+        const __m128 cs = _mm_set1_ps(c);
+        const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        const __m128 zero = _mm_setzero_ps();
+
+        __m128 best = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+        __m128i bestIndex = _mm_setzero_si128();
+        __m128i index = _mm_set_epi32(3, 2, 1, 0);
+        const __m128i step = _mm_set1_epi32(4);
+
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(visits + i)));
+            __m128 s = _mm_loadu_ps(scoreSums + i);
+            __m128 score = _mm_add_ps(_mm_div_ps(s, v), _mm_mul_ps(cs, _mm_sqrt_ps(_mm_div_ps(logN, v))));
+            __m128 unvisited = _mm_cmpeq_ps(v, zero);
+            score = _mm_or_ps(_mm_and_ps(unvisited, inf), _mm_andnot_ps(unvisited, score));
+
+            // Strictly greater keeps the first index of equal values in every lane
+            __m128 greater = _mm_cmpgt_ps(score, best);
+            best = _mm_or_ps(_mm_and_ps(greater, score), _mm_andnot_ps(greater, best));
+            __m128i greaterMask = _mm_castps_si128(greater);
+            bestIndex = _mm_or_si128(_mm_and_si128(greaterMask, index), _mm_andnot_si128(greaterMask, bestIndex));
+            index = _mm_add_epi32(index, step);
+        }
+
+        alignas(16) float lanes[4];
+        alignas(16) int laneIndices[4];
+        _mm_store_ps(lanes, best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(laneIndices), bestIndex);
+
+        return reduce(lanes, laneIndices, 4, scoreSums, visits, i, n, logParentVisits, c);
+    }
+#endif
+
+#if defined(CPP_MCTS_AVX2_DISPATCH)
+    __attribute__((target("avx2"))) static std::size_t selectAVX2(const float* scoreSums, const int* visits, std::size_t n, float logParentVisits, float c)
+    {
+        const __m256 logN = _mm256_set1_ps(logParentVisits);
+        const __m256 cs = _mm256_set1_ps(c);
+        const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        const __m256 zero = _mm256_setzero_ps();
+
+        __m256 best = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+        __m256i bestIndex = _mm256_setzero_si256();
+        __m256i index = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        const __m256i step = _mm256_set1_epi32(8);
+
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(visits + i)));
+            __m256 s = _mm256_loadu_ps(scoreSums + i);
+            __m256 score = _mm256_add_ps(_mm256_div_ps(s, v), _mm256_mul_ps(cs, _mm256_sqrt_ps(_mm256_div_ps(logN, v))));
+            score = _mm256_blendv_ps(score, inf, _mm256_cmp_ps(v, zero, _CMP_EQ_OQ));
+
+            // Strictly greater keeps the first index of equal values in every lane
+            __m256 greater = _mm256_cmp_ps(score, best, _CMP_GT_OQ);
+            best = _mm256_blendv_ps(best, score, greater);
+            bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(greater));
+            index = _mm256_add_epi32(index, step);
+        }
+
+        alignas(32) float lanes[8];
+        alignas(32) int laneIndices[8];
+        _mm256_store_ps(lanes, best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(laneIndices), bestIndex);
+
+        return reduce(lanes, laneIndices, 8, scoreSums, visits, i, n, logParentVisits, c);
+    }
+#endif
+
+    /**
+     * @return The UCT value of a single child
+     */
+    static float value(float scoreSum, int visits, float logParentVisits, float c)
+    {
+        if (visits == 0)
+            return std::numeric_limits<float>::infinity();
+
+        float n = static_cast<float>(visits);
+        return scoreSum / n + c * std::sqrt(logParentVisits / n);
+    }
+
+private:
+    /**
+     * Combine the per-lane maxima of a vector kernel and the children left over
+     * after the last full vector into the index of the best child.
+     */
+    static std::size_t reduce(const float* lanes, const int* laneIndices, std::size_t numLanes, const float* scoreSums,
+        const int* visits, std::size_t tail, std::size_t n, float logParentVisits, float c)
+    {
+        std::size_t best = 0;
+        float bestScore = -std::numeric_limits<float>::infinity();
+
+        // Without any full vector, the lanes hold no children
+        if (tail > 0) {
+            best = static_cast<std::size_t>(laneIndices[0]);
+            bestScore = lanes[0];
+            for (std::size_t lane = 1; lane < numLanes; lane++) {
+                auto laneIndex = static_cast<std::size_t>(laneIndices[lane]);
+                if (lanes[lane] > bestScore || (lanes[lane] == bestScore && laneIndex < best)) {
+                    bestScore = lanes[lane];
+                    best = laneIndex;
+                }
+            }
+        }
+
+        for (std::size_t i = tail; i < n; i++) {
+            float score = value(scoreSums[i], visits[i], logParentVisits, c);
+            if (score > bestScore) {
+                bestScore = score;
+                best = i;
+            }
+        }
+
+        return best;
+    }
+};
+
+#endif // CPP_MCTS_UCT_HPP
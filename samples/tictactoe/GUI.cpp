@@ -20,6 +20,7 @@ GUI::GUI(QWidget* parent)
     , scene()
     , view()
     , timer()
+    , searchTimer()
     , pen()
 {
     createPlayerSelect();
@@ -79,6 +80,10 @@ void GUI::createBoard()
     timer = new QTimer();
     timer->setSingleShot(true);
     connect(timer, SIGNAL(timeout()), this, SLOT(movePlayed()));
+
+    searchTimer = new QTimer();
+    searchTimer->setInterval(SEARCH_POLL_INTERVAL);
+    connect(searchTimer, SIGNAL(timeout()), this, SLOT(searchProgressed()));
 }
 
 void GUI::fillScene()
@@ -137,6 +142,10 @@ QGraphicsItem* GUI::createGrid(qreal size)
 
 void GUI::endGame()
 {
+    // Pondering would otherwise go on until the root of the finished game is proven
+    crossPlayer.stop();
+    circlePlayer.stop();
+
     player1Select->setDisabled(false);
     player2Select->setDisabled(false);
     startGame->setDisabled(false);
@@ -178,11 +187,24 @@ void GUI::movePlayed()
     }
 
     if (!isCurrentPlayerHuman()) {
-        auto action = TTTMCTSPlayer::calculateAction(board);
-        playMove(action.getX(), action.getY());
+        // Search in the background so the window keeps responding
+        auto& player = board.getCurrentPlayer() == Player::CROSS ? crossPlayer : circlePlayer;
+        player.startSearch(board);
+        searchTimer->start();
     }
 }
 
+void GUI::searchProgressed()
+{
+    auto& player = board.getCurrentPlayer() == Player::CROSS ? crossPlayer : circlePlayer;
+    if (!player.isSearchDone())
+        return;
+
+    searchTimer->stop();
+    auto action = player.finishSearch();
+    playMove(action.getX(), action.getY());
+}
+
 void GUI::newGame()
 {
     player1Select->setDisabled(true);
@@ -194,6 +216,11 @@ void GUI::newGame()
     fillScene();
 
     board = Board();
+    // The searches must end before the trees they search are replaced
+    crossPlayer.stop();
+    circlePlayer.stop();
+    crossPlayer = TTTMCTSPlayer();
+    circlePlayer = TTTMCTSPlayer();
 
     // Return control back to event loop for redrawing
     timer->start();
@@ -27,11 +27,15 @@ class GUI : public QWidget {
     constexpr static qreal BOX_SIZE = SCENE_SIZE / 3;
     constexpr static qreal BOX_PADDING = 50;
     const static int PEN_WIDTH = 7;
+    /** Milliseconds between checks whether a search has ended */
+    const static int SEARCH_POLL_INTERVAL = 20;
 
     /*
      * Game logic
      */
     Board board;
+    TTTMCTSPlayer crossPlayer;
+    TTTMCTSPlayer circlePlayer;
 
     /*
      * Player selection
@@ -49,6 +53,8 @@ class GUI : public QWidget {
     QGraphicsScene* scene;
     QGraphicsView* view;
     QTimer* timer;
+    /** Checks whether the search of the current AI player has ended */
+    QTimer* searchTimer;
     QPen* pen;
 
 public:
@@ -74,6 +80,7 @@ private slots:
     void newGame();
     void boardClicked();
     void movePlayed();
+    void searchProgressed();
 };
 
 #endif // CPP_MCTS_GUI_HPP
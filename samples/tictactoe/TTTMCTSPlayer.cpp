@@ -9,8 +9,60 @@
 
 TTTAction TTTMCTSPlayer::calculateAction(const Board& board)
 {
-    auto mcts = createMCTS(board);
-    return mcts.calculateAction();
+    startSearch(board);
+    return finishSearch();
+}
+
+void TTTMCTSPlayer::startSearch(const Board& board)
+{
+    if (mcts)
+        mcts->stopPondering();
+    if (!mcts || !advanceTo(board))
+        mcts.reset(new TTTMCTS(createMCTS(board)));
+
+    search = mcts->calculateActionAsync();
+}
+
+bool TTTMCTSPlayer::isSearchDone() const { return search.isDone(); }
+
+TTTAction TTTMCTSPlayer::finishSearch()
+{
+    auto action = search.get();
+    mcts->advance(action);
+
+    // Search on while the opponent thinks, the next search starts from the subtree of its move
+    mcts->startPondering();
+    return action;
+}
+
+void TTTMCTSPlayer::stop()
+{
+    // Replacing the handle stops a search that is still running
+    search = AsyncSearch<TTTAction>();
+    if (mcts)
+        mcts->stopPondering();
+}
+
+bool TTTMCTSPlayer::advanceTo(const Board& board)
+{
+    const Board& root = mcts->getRoot().getData();
+    if (board.getTurns() != root.getTurns() + 1)
+        return false;
+
+    TTTAction played;
+    for (int x = 0; x < 3; x++) {
+        for (int y = 0; y < 3; y++) {
+            if (root.position(x, y) == board.position(x, y))
+                continue;
+            // Only an empty square can have been played on
+            if (root.position(x, y) != Player::NONE)
+                return false;
+            played = TTTAction(x, y);
+        }
+    }
+
+    mcts->advance(played);
+    return true;
 }
 
 TTTMCTS TTTMCTSPlayer::createMCTS(const Board& board)
@@ -18,6 +70,9 @@ TTTMCTS TTTMCTSPlayer::createMCTS(const Board& board)
     auto backpropagation = new TTTBackpropagation(board.getCurrentPlayer());
     auto terminationCheck = new TTTTerminationCheck();
     auto scoring = new TTTScoring(board.getCurrentPlayer());
-    return TTTMCTS(Board(board), backpropagation, terminationCheck,
-        scoring);
+    TTTMCTS mcts(Board(board), backpropagation, terminationCheck, scoring);
+
+    // Tic-tac-toe is small enough to be proven, the search ends as soon as the outcome of the board is known
+    mcts.setSolver(true);
+    return mcts;
 }
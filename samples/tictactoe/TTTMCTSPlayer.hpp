@@ -16,17 +16,55 @@
 using TTTMCTS = MCTS<Board, TTTAction, TTTExpansionStrategy, TTTPlayoutStrategy>;
 
 class TTTMCTSPlayer {
+    /** The search tree of the previous move, kept to start the next search warm */
+    std::unique_ptr<TTTMCTS> mcts;
+
+    /** The search started by startSearch(), if it was not finished yet */
+    AsyncSearch<TTTAction> search;
+
 public:
     /**
-     * Will play one move on the board passed through the constructor.
+     * Calculate the move to play on the given board.
+     *
+     * When the board follows from the previous move by one move of the opponent, the tree of the previous search is
+     * reused. That tree keeps being searched while the opponent thinks.
+     */
+    TTTAction calculateAction(const Board& board);
+
+    /**
+     * Start calculating the move to play on the given board in the background, see calculateAction().
      */
-    static TTTAction calculateAction(const Board& board);
+    void startSearch(const Board& board);
+
+    /**
+     * @return True once the move of the search started by startSearch() is known
+     */
+    bool isSearchDone() const;
+
+    /**
+     * Wait for the search started by startSearch() to end.
+     *
+     * @return The move to play
+     */
+    TTTAction finishSearch();
+
+    /**
+     * Stop searching and pondering, e.g. when the game has ended.
+     */
+    void stop();
 
 private:
     /**
      * Creates a new MCTS instance.
      */
     static TTTMCTS createMCTS(const Board& board);
+
+    /**
+     * Advance the tree of the previous search along the move the opponent played to reach board.
+     *
+     * @return False if board does not follow from the root of the tree by a single move
+     */
+    bool advanceTo(const Board& board);
 };
 
 class TTTBackpropagation : public Backpropagation<Board> {
@@ -49,13 +49,13 @@ TTTPlayoutStrategy::TTTPlayoutStrategy(Board* state)
 
 void TTTPlayoutStrategy::generateRandom(TTTAction& action)
 {
-    int x = distribution(generator);
-    int y = distribution(generator);
+    int x = distribution(*rng);
+    int y = distribution(*rng);
 
     // search the Board until an empty square is found
     while (state->position(x, y) != Player::NONE) {
-        x = distribution(generator);
-        y = distribution(generator);
+        x = distribution(*rng);
+        y = distribution(*rng);
     }
     action.setX(x);
     action.setY(y);
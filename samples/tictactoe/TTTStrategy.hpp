@@ -25,8 +25,6 @@ private:
 };
 
 class TTTPlayoutStrategy : public PlayoutStrategy<Board, TTTAction> {
-    std::random_device device;
-    std::mt19937 generator = std::mt19937(device());
     std::uniform_int_distribution<uint> distribution = std::uniform_int_distribution<uint>(0, 2);
 
 public:
@@ -0,0 +1,129 @@
+#include "TestGame.hpp"
+#include "catch2/catch.hpp"
+#include "mcts/engine.hpp"
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using TestGameSearchEngine = SearchEngine<TestGameState, TestGameAction, TestGameExpansionStrategy,
+    TestGamePlayoutStrategy>;
+
+namespace {
+
+TestGameSearchEngine::Factory createFactory(int minIterations)
+{
+    // The engine sets the time of every search from the budget of its request
+    return [minIterations](const TestGameState& state) { return makeTestGameMCTS(state, minIterations); };
+}
+
+}
+
+TEST_CASE("search engines answer the requests of many sessions")
+{
+    TestGameSearchEngine engine(createFactory(3000), 2);
+
+    std::vector<std::future<TestGameAction>> results;
+    for (int i = 0; i < 8; i++)
+        results.push_back(engine.submit(TestGameState(10, 5), std::chrono::milliseconds(0), i % 2 ? "blitz" : "classic"));
+
+    for (auto& result : results)
+        REQUIRE(result.get() == TestGameAction(3));
+
+    engine.wait();
+    REQUIRE(engine.getQueueDepth() == 0);
+
+    auto metrics = engine.getMetrics();
+    REQUIRE(metrics.size() == 2);
+    for (const auto& entry : metrics) {
+        REQUIRE(entry.second.queued == 0);
+        REQUIRE(entry.second.completed == 4);
+        REQUIRE(entry.second.failed == 0);
+        // Every search runs its minimum number of iterations after the deadline
+        REQUIRE(entry.second.deadlineMisses == 4);
+        REQUIRE(entry.second.p50Latency > std::chrono::microseconds(0));
+        REQUIRE(entry.second.p50Latency <= entry.second.p99Latency);
+    }
+}
+
+TEST_CASE("search engines answer the request with the earliest deadline first")
+{
+    auto pool = std::make_shared<ThreadPool>(1);
+    TestGameSearchEngine engine(createFactory(100), pool);
+    engine.setDeadlineMargin(std::chrono::milliseconds(0));
+
+    // Keep the only worker busy until all requests are queued
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pool->submit([released]() { released.wait(); });
+
+    std::mutex mutex;
+    std::vector<int> answered;
+    for (int budget : { 40, 10, 30, 20 }) {
+        engine.submit(TestGameState(10, 5), std::chrono::milliseconds(budget), "", [&mutex, &answered, budget](const TestGameAction&, std::exception_ptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            answered.push_back(budget);
+        });
+    }
+    REQUIRE(engine.getQueueDepth() == 4);
+    REQUIRE(engine.getMetrics()[""].queued == 4);
+
+    release.set_value();
+    engine.wait();
+
+    REQUIRE(answered == std::vector<int> { 10, 20, 30, 40 });
+    REQUIRE(engine.getMetrics()[""].completed == 4);
+}
+
+TEST_CASE("search engines reuse the trees of a session class")
+{
+    int created = 0;
+    auto factory = createFactory(1000);
+    // A pool without workers searches every request on the submitting thread
+    TestGameSearchEngine engine([&created, &factory](const TestGameState& state) {
+        created++;
+        return factory(state);
+    }, 0);
+
+    TestGameState next(10, 5);
+    next.addChoice(3);
+
+    REQUIRE(engine.submit(TestGameState(10, 5), std::chrono::milliseconds(0), "blitz").get() == TestGameAction(3));
+    REQUIRE(engine.submit(next, std::chrono::milliseconds(0), "blitz").get() == TestGameAction(1));
+    REQUIRE(created == 1);
+
+    REQUIRE(engine.submit(next, std::chrono::milliseconds(0), "classic").get() == TestGameAction(1));
+    REQUIRE(created == 2);
+}
+
+TEST_CASE("search engines report failed searches to the callback")
+{
+    // A pool without workers searches on the submitting thread
+    TestGameSearchEngine engine([](const TestGameState&) -> TestGameSearchEngine::Tree {
+        throw std::runtime_error("no tree");
+    }, 0);
+
+    std::exception_ptr reported;
+    engine.submit(TestGameState(10, 5), std::chrono::milliseconds(0), "", [&reported](const TestGameAction&, std::exception_ptr error) {
+        reported = error;
+    });
+
+    REQUIRE(reported);
+    REQUIRE_THROWS_AS(std::rethrow_exception(reported), std::runtime_error);
+    REQUIRE(engine.getMetrics()[""].failed == 1);
+
+    SECTION("a throwing callback still ends its request")
+    {
+        REQUIRE_THROWS_AS(engine.submit(TestGameState(10, 5), std::chrono::milliseconds(0), "",
+                              [](const TestGameAction&, std::exception_ptr) { throw std::logic_error("callback"); }),
+            std::logic_error);
+
+        // Returns instead of waiting for the request forever
+        engine.wait();
+        REQUIRE(engine.getMetrics()[""].completed == 2);
+    }
+}
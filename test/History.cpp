@@ -0,0 +1,51 @@
+#include "catch2/catch.hpp"
+#include "mcts/history.hpp"
+
+#include <set>
+#include <stdexcept>
+
+TEST_CASE("history tables average the scores of every action")
+{
+    HistoryTable table;
+    table.reset(HistoryTable::DEFAULT_BITS);
+    REQUIRE(table.getBits() == HistoryTable::DEFAULT_BITS);
+
+    table.update(1, 1.0F, 1);
+    table.update(1, 0.0F, 1);
+    table.update(2, 1.5F, 2);
+
+    REQUIRE(table.getAvgScore(1) == Approx(0.5F));
+    REQUIRE(table.getAvgScore(2) == Approx(0.75F));
+    REQUIRE(table.getAvgScore(3) == 0.0F);
+
+    table.reset(HistoryTable::DEFAULT_BITS);
+    REQUIRE(table.getAvgScore(1) == 0.0F);
+}
+
+TEST_CASE("history tables share entries between colliding actions")
+{
+    HistoryTable table;
+    table.reset(1);
+
+    table.update(0, 1.0F, 1);
+    table.update(1, 0.0F, 1);
+    table.update(2, 0.5F, 1);
+
+    // Three actions in two entries, at least two of them report a shared average
+    std::set<float> averages;
+    for (std::size_t hash = 0; hash < 3; hash++)
+        averages.insert(table.getAvgScore(hash));
+    REQUIRE(averages.size() <= 2);
+}
+
+TEST_CASE("history tables reject sizes they cannot index")
+{
+    HistoryTable table;
+
+    REQUIRE_THROWS_AS(table.reset(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(table.reset(HistoryTable::MAX_BITS + 1), std::invalid_argument);
+    REQUIRE(table.getBits() == 0);
+
+    table.reset(1);
+    REQUIRE(table.getBits() == 1);
+}
@@ -1,21 +1,22 @@
-
 #include "Mocks.hpp"
 #include "catch2/catch.hpp"
 #include "mcts/mcts.hpp"
 
 using MockNode = Node<MockState, MockAction, MockExpansionStrategy>;
 
-std::shared_ptr<MockNode> buildMockNode(unsigned int id, std::shared_ptr<MockNode> parent)
+MockNode* buildMockNode(ObjectPool<MockNode>& pool, NodeIndex parent)
 {
-    return std::make_shared<MockNode>(id, MockState(), parent, MockAction());
+    static MockState state;
+    return pool.create(pool.size(), &state, parent, MockAction());
 }
 
 TEST_CASE("nodes can have their scores updated")
 {
-    auto node = buildMockNode(1, nullptr);
+    ObjectPool<MockNode> pool;
+    auto node = buildMockNode(pool, NO_NODE);
 
     REQUIRE(node->getNumVisits() == 0);
-    REQUIRE(isnan(node->getAvgScore()));
+    REQUIRE(std::isnan(node->getAvgScore()));
 
     SECTION("updating scores")
     {
@@ -33,17 +34,88 @@ TEST_CASE("nodes can have their scores updated")
 
 TEST_CASE("nodes can build a tree")
 {
-    auto root = buildMockNode(1, nullptr);
-    auto childA = buildMockNode(2, root);
-    auto childB = buildMockNode(3, root);
+    ObjectPool<MockNode> pool;
+    auto root = buildMockNode(pool, NO_NODE);
+    auto childA = buildMockNode(pool, root->getID());
+    auto childB = buildMockNode(pool, root->getID());
 
     REQUIRE(root->getChildren().empty());
+    REQUIRE(root->getParent() == NO_NODE);
+    REQUIRE(childA->getParent() == root->getID());
 
     SECTION("Add children")
     {
-        root->addChild(childA);
-        root->addChild(childB);
+        root->addChild(childA->getID(), childA->getAction());
+        root->addChild(childB->getID(), childB->getAction());
+
+        REQUIRE(root->getChildren() == std::vector<NodeIndex> { childA->getID(), childB->getID() });
+        REQUIRE(&pool[childB->getID()] == childB);
+    }
+
+    SECTION("children statistics are stored in the parent")
+    {
+        root->addChild(childA->getID(), childA->getAction());
+        root->addChild(childB->getID(), childB->getAction());
+        root->updateChild(1, 0.25F);
+        root->updateChild(1, 0.5F);
+
+        REQUIRE(root->getChildVisits() == std::vector<int> { 0, 2 });
+        REQUIRE(root->getChildScoreSums()[1] == Approx(0.75F));
+    }
+
+    SECTION("the actions of children are stored in the parent once a child does not hold its own")
+    {
+        root->addChild(childA->getID(), MockAction());
+
+        REQUIRE_FALSE(root->hasChildActions());
+
+        root->storeChildActions(pool);
+        root->addSharedChild(childB->getID(), MockAction());
+
+        REQUIRE(root->hasChildActions());
+        REQUIRE(root->getChildren() == std::vector<NodeIndex> { childA->getID(), childB->getID() });
+        REQUIRE(root->getChildVisits() == std::vector<int> { 0, 0 });
+    }
+
+    SECTION("all-moves-as-first statistics are only allocated when used")
+    {
+        root->addChild(childA->getID(), childA->getAction());
+        root->addChild(childB->getID(), childB->getAction());
+
+        REQUIRE(root->getChildAmafVisits().empty());
+
+        root->updateChildAmaf(1, 1.5F, 2);
+
+        REQUIRE(root->getChildAmafVisits() == std::vector<int> { 0, 2 });
+        REQUIRE(root->getChildAmafScoreSums()[1] == Approx(1.5F));
+        REQUIRE(root->getChildVisits() == std::vector<int> { 0, 0 });
+    }
+
+    SECTION("the hashes of the actions of children are kept once computed")
+    {
+        root->addChild(childA->getID(), childA->getAction());
+        root->addChild(childB->getID(), childB->getAction());
+
+        REQUIRE(root->getChildActionHashes().empty());
+
+        root->addChildActionHash(7);
+
+        REQUIRE(root->getChildActionHashes() == std::vector<std::size_t> { 7 });
+        REQUIRE(root->getChildAmafVisits().empty());
+    }
+
+    SECTION("proven children are recorded in the parent")
+    {
+        root->addChild(childA->getID(), childA->getAction());
+        root->addChild(childB->getID(), childB->getAction());
+
+        REQUIRE_FALSE(root->hasSolvedChildren());
+
+        root->setChildSolved(0, 0.25F, 0.75F);
 
-        REQUIRE(root->getChildren() == std::vector<std::shared_ptr<MockNode>> { childA, childB });
+        REQUIRE(root->isChildSolved(0));
+        REQUIRE_FALSE(root->isChildSolved(1));
+        REQUIRE(root->getChildSolvedResults()[0] == 0.75F);
+        REQUIRE_FALSE(root->isSolved());
     }
 }
@@ -0,0 +1,210 @@
+#include "TestGame.hpp"
+#include "catch2/catch.hpp"
+#include "mcts/parallel.hpp"
+
+#include <chrono>
+#include <memory>
+
+using TestGameRootParallelMCTS = RootParallelMCTS<TestGameState, TestGameAction, TestGameExpansionStrategy,
+    TestGamePlayoutStrategy>;
+
+TEST_CASE("root parallel MCTS merges the statistics of all trees")
+{
+    auto factory = [](const TestGameState& state) { return makeTestGameMCTS(state, 3000); };
+
+    TestGameRootParallelMCTS mcts(TestGameState(10, 5), 3, factory);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(mcts.getNumThreads() == 3);
+    REQUIRE(mcts.getIterations() == 9000);
+
+    int mergedVisits = 0;
+    for (const auto& entry : mcts.getRootStatistics())
+        mergedVisits += entry.numVisits;
+
+    int treeVisits = 0;
+    for (std::size_t i = 0; i < mcts.getNumThreads(); i++) {
+        for (const auto& entry : mcts.getTree(i).getRootStatistics())
+            treeVisits += entry.numVisits;
+    }
+
+    REQUIRE(mergedVisits == treeVisits);
+    REQUIRE(mergedVisits > 0);
+}
+
+TEST_CASE("root parallel MCTS plays the action proven by any of its trees")
+{
+    auto factory = [](const TestGameState& state) {
+        TestGameMCTS mcts(state, new TestGameBackPropagation(), new TestGameTerminationCheck(),
+            new TestGameScoring({ 2, 0, 1, 2 }));
+        mcts.setSolver(true);
+        mcts.setTime(0);
+        mcts.setMinIterations(10000);
+        return mcts;
+    };
+
+    TestGameRootParallelMCTS mcts(TestGameState(4, 2), 3, factory);
+
+    REQUIRE(mcts.calculateAction() == TestGameAction(2));
+    REQUIRE(mcts.getTree(0).isSolved());
+}
+
+/**
+ * Check that the statistics every node keeps for its children match the children themselves, which fails if virtual
+ * loss was not removed or concurrent updates were lost.
+ */
+static void checkChildStatistics(const TestGameMCTS& mcts, NodeIndex index)
+{
+    const auto& node = mcts.getNode(index);
+    for (std::size_t i = 0; i < node.getChildren().size(); i++) {
+        const auto& child = mcts.getNode(node.getChildren()[i]);
+        REQUIRE(node.getChildVisits()[i] == child.getNumVisits());
+        REQUIRE(node.getChildScoreSums()[i] == Approx(child.getAvgScore() * child.getNumVisits()).margin(0.01));
+        checkChildStatistics(mcts, node.getChildren()[i]);
+    }
+}
+
+TEST_CASE("tree parallel MCTS searches one shared tree")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 9000);
+    mcts.setNumThreads(3);
+    mcts.setVirtualLoss(3);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(mcts.getNumThreads() == 3);
+    REQUIRE(mcts.getIterations() == 9000);
+    REQUIRE(mcts.getRoot().getNumVisits() == 9000);
+    checkChildStatistics(mcts, mcts.getRootIndex());
+}
+
+TEST_CASE("tree parallel MCTS rejects eviction")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 0);
+    mcts.setNumThreads(2);
+    mcts.setMaxNodes(100, MemoryLimitPolicy::EVICT_LEAST_VISITED);
+
+    REQUIRE_THROWS_AS(mcts.search(), std::logic_error);
+}
+
+TEST_CASE("leaf parallel MCTS runs several playouts per iteration")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 3000);
+    mcts.setLeafParallelism(4);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(mcts.getIterations() == 3000);
+    REQUIRE(mcts.getRoot().getNumVisits() == 4 * 3000);
+    checkChildStatistics(mcts, mcts.getRootIndex());
+}
+
+TEST_CASE("MCTS instances can share a thread pool")
+{
+    auto pool = std::make_shared<ThreadPool>(2);
+    std::vector<TestGameMCTS> searches;
+    for (int i = 0; i < 2; i++) {
+        searches.push_back(makeTestGameMCTS(TestGameState(10, 5), 2000));
+        searches.back().setNumThreads(2);
+        searches.back().setLeafParallelism(2, pool);
+    }
+
+    for (auto& mcts : searches) {
+        REQUIRE(mcts.calculateAction() == TestGameAction(3));
+        REQUIRE(mcts.getThreadPool() == pool);
+        checkChildStatistics(mcts, mcts.getRootIndex());
+    }
+}
+
+TEST_CASE("asynchronous searches report their progress until they are stopped")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 0);
+    mcts.setTime(60000);
+    mcts.setTimeSlack(std::chrono::milliseconds(1));
+
+    auto search = mcts.calculateActionAsync();
+    REQUIRE(search.valid());
+    while (search.getIterations() < 3000)
+        REQUIRE_FALSE(search.waitFor(std::chrono::milliseconds(1)));
+
+    REQUIRE_FALSE(search.getRootStatistics().empty());
+    search.requestStop();
+    REQUIRE(search.waitFor(std::chrono::seconds(10)));
+
+    auto action = search.get();
+    REQUIRE_FALSE(search.valid());
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(search.getBestAction() == action);
+    REQUIRE(search.getIterations() == mcts.getIterations());
+    checkChildStatistics(mcts, mcts.getRootIndex());
+}
+
+TEST_CASE("asynchronous searches end with the same action as blocking searches")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 3000);
+    mcts.setNumThreads(2);
+
+    auto search = mcts.calculateActionAsync();
+    search.wait();
+    REQUIRE(search.isDone());
+    REQUIRE(search.get() == TestGameAction(3));
+
+    // Destroying the handle of a running search stops it
+    mcts.setTime(60000);
+    mcts.setMinIterations(0);
+    auto start = std::chrono::steady_clock::now();
+    {
+        auto stopped = mcts.calculateActionAsync();
+    }
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+    checkChildStatistics(mcts, mcts.getRootIndex());
+}
+
+#if defined(CPP_MCTS_STOP_TOKEN)
+TEST_CASE("asynchronous searches stop through a stop token")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 0);
+    mcts.setTime(60000);
+
+    std::stop_source stopSource;
+    auto search = mcts.calculateActionAsync(stopSource.get_token());
+    REQUIRE_FALSE(search.isStopRequested());
+
+    stopSource.request_stop();
+    REQUIRE(search.isStopRequested());
+    REQUIRE(search.waitFor(std::chrono::seconds(10)));
+}
+#endif
+
+TEST_CASE("pondering keeps the visits of the action the opponent plays")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), 1000);
+    mcts.setTimeSlack(std::chrono::milliseconds(1));
+
+    auto action = mcts.calculateAction();
+    REQUIRE(mcts.advance(action));
+    int visitsBefore = mcts.getRoot().getNumVisits();
+
+    mcts.startPondering();
+    REQUIRE(mcts.isPondering());
+    while (mcts.getPonderSearch().getIterations() < 3000)
+        REQUIRE_FALSE(mcts.getPonderSearch().waitFor(std::chrono::milliseconds(1)));
+
+    // The opponent plays the expected action, so its subtree grew while pondering
+    auto predicted = mcts.getPonderSearch().getBestAction();
+    REQUIRE(predicted == TestGameAction(1));
+    REQUIRE(mcts.advance(predicted));
+    REQUIRE_FALSE(mcts.isPondering());
+    REQUIRE(mcts.getRoot().getNumVisits() > visitsBefore);
+    checkChildStatistics(mcts, mcts.getRootIndex());
+
+    // Searching stops pondering as well
+    mcts.startPondering();
+    REQUIRE(mcts.calculateAction() == TestGameAction(4));
+    REQUIRE_FALSE(mcts.isPondering());
+    REQUIRE(mcts.stopPondering() == 0);
+}
@@ -0,0 +1,133 @@
+/** @file PlainGame.cpp
+ * @brief The game from TestGame.hpp implemented without deriving from any of the MCTS interfaces.
+ */
+
+#include "TestGame.hpp"
+#include "catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+struct PlainState {
+    uint numTurns;
+    uint maxChoice;
+    std::vector<uint> choices;
+};
+
+struct PlainAction {
+    uint choice = 0;
+
+    PlainAction() = default;
+
+    explicit PlainAction(uint choice)
+        : choice(choice)
+    {
+    }
+
+    void execute(PlainState& state) const { state.choices.push_back(choice); }
+
+    bool operator==(const PlainAction& other) const { return choice == other.choice; }
+};
+
+/**
+ * A stateless ExpansionStrategy, it is passed the state of its node instead of keeping a pointer to it.
+ */
+struct PlainExpansionStrategy {
+    uint currentChoice = 0;
+
+    explicit PlainExpansionStrategy(const PlainState& /* state */) { }
+
+    PlainAction generateNext(const PlainState& /* state */) { return PlainAction(currentChoice++); }
+
+    bool canGenerateNext(const PlainState& state) const { return currentChoice <= state.maxChoice; }
+};
+
+/**
+ * A stateless ExpansionStrategy generating all actions at once.
+ */
+struct PlainBatchExpansionStrategy : PlainExpansionStrategy {
+    using PlainExpansionStrategy::PlainExpansionStrategy;
+
+    void generateAll(const PlainState& state, std::vector<PlainAction>& actions) const
+    {
+        for (uint choice = 0; choice <= state.maxChoice; choice++)
+            actions.emplace_back(choice);
+    }
+};
+
+struct PlainPlayoutStrategy {
+    PlainState* state;
+    std::mt19937* rng = nullptr;
+
+    explicit PlainPlayoutStrategy(PlainState* state)
+        : state(state)
+    {
+    }
+
+    void setRandomGenerator(std::mt19937* newRng) { rng = newRng; }
+
+    void generateRandom(PlainAction& action)
+    {
+        action.choice = std::uniform_int_distribution<uint>(0, state->maxChoice)(*rng);
+    }
+};
+
+struct PlainBackpropagation {
+    float updateScore(const PlainState& /* state */, float score) const { return score; }
+};
+
+struct PlainTerminationCheck {
+    bool isTerminal(const PlainState& state) const { return state.choices.size() == state.numTurns; }
+};
+
+struct PlainScoring {
+    std::vector<uint> correctNumbers;
+
+    float score(const PlainState& state) const
+    {
+        uint correct = 0;
+        for (std::size_t i = 0; i < state.choices.size(); i++)
+            correct += state.choices[i] == correctNumbers[i] ? 1 : 0;
+        return (float)correct / (float)state.choices.size();
+    }
+};
+
+using PlainMCTS = MCTS<PlainState, PlainAction, PlainExpansionStrategy, PlainPlayoutStrategy, PlainBackpropagation,
+    PlainTerminationCheck, PlainScoring>;
+
+#if defined(CPP_MCTS_CONCEPTS)
+static_assert(GameExpansionStrategy<PlainExpansionStrategy, PlainState, PlainAction>, "stateless expansion");
+static_assert(GameExpansionStrategy<TestGameExpansionStrategy, TestGameState, TestGameAction>, "virtual expansion");
+static_assert(!GameAction<PlainAction, TestGameState>, "actions are checked against the state type");
+#endif
+
+}
+
+TEST_CASE("MCTS searches games that do not derive from the MCTS interfaces")
+{
+    PlainMCTS mcts(PlainState { 10, 5, {} }, PlainBackpropagation(), PlainTerminationCheck(),
+        PlainScoring { TEST_GAME_SEQUENCE });
+    mcts.setTime(0);
+    mcts.setMinIterations(3000);
+
+    REQUIRE(mcts.calculateAction() == PlainAction(3));
+
+    // Without vtables and state pointers, nodes are smaller
+    REQUIRE(sizeof(Node<PlainState, PlainAction, PlainExpansionStrategy>)
+        < sizeof(Node<TestGameState, TestGameAction, TestGameExpansionStrategy>));
+}
+
+TEST_CASE("stateless ExpansionStrategies can generate all actions at once")
+{
+    MCTS<PlainState, PlainAction, PlainBatchExpansionStrategy, PlainPlayoutStrategy, PlainBackpropagation,
+        PlainTerminationCheck, PlainScoring>
+        mcts(PlainState { 10, 5, {} }, PlainBackpropagation(), PlainTerminationCheck(),
+            PlainScoring { TEST_GAME_SEQUENCE });
+    mcts.setTime(0);
+    mcts.setMinIterations(3000);
+
+    REQUIRE(mcts.calculateAction() == PlainAction(3));
+    REQUIRE(mcts.getRoot().getChildren().size() == 6);
+}
@@ -0,0 +1,108 @@
+#include "catch2/catch.hpp"
+#include "mcts/pool.hpp"
+
+#include <vector>
+
+namespace {
+
+struct Counted {
+    static int alive;
+    int value;
+
+    explicit Counted(int value)
+        : value(value)
+    {
+        alive++;
+    }
+
+    ~Counted() { alive--; }
+};
+
+int Counted::alive = 0;
+
+}
+
+TEST_CASE("object pools keep objects in place across chunks")
+{
+    ObjectPool<Counted> pool;
+    std::vector<Counted*> created;
+
+    // Enough objects to span several chunks
+    for (int i = 0; i < 5000; i++)
+        created.push_back(pool.create(i));
+
+    REQUIRE(pool.size() == 5000);
+    REQUIRE(Counted::alive == 5000);
+    for (int i = 0; i < 5000; i++)
+        REQUIRE(created[i]->value == i);
+
+    SECTION("clearing destroys all objects")
+    {
+        pool.clear();
+
+        REQUIRE(pool.size() == 0);
+        REQUIRE(Counted::alive == 0);
+    }
+
+    SECTION("resetting destroys all objects and reuses the chunks")
+    {
+        pool.reset();
+
+        REQUIRE(pool.size() == 0);
+        REQUIRE(Counted::alive == 0);
+        REQUIRE(pool.create(-1) == created[0]);
+    }
+
+    SECTION("moving transfers ownership")
+    {
+        ObjectPool<Counted> other(std::move(pool));
+
+        REQUIRE(pool.size() == 0);
+        REQUIRE(other.size() == 5000);
+        REQUIRE(created[4999]->value == 4999);
+    }
+}
+
+TEST_CASE("object pools can be indexed in order of creation")
+{
+    ObjectPool<Counted> pool;
+
+    for (int i = 0; i < 1000; i++)
+        pool.create(i);
+
+    for (std::uint32_t i = 0; i < pool.size(); i++) {
+        REQUIRE(pool[i].value == (int)i);
+        REQUIRE(pool.indexOf(&pool[i]) == i);
+    }
+
+    pool.clear();
+}
+
+TEST_CASE("object pools reuse the slots of destroyed objects")
+{
+    ObjectPool<Counted> pool;
+
+    for (int i = 0; i < 10; i++)
+        pool.create(i);
+
+    pool.destroy(3);
+    pool.destroy(7);
+
+    REQUIRE(pool.size() == 8);
+    REQUIRE(pool.bound() == 10);
+    REQUIRE(Counted::alive == 8);
+    REQUIRE_FALSE(pool.contains(3));
+    REQUIRE(pool.contains(4));
+
+    REQUIRE(pool.nextIndex() == 7);
+    pool.create(70);
+    REQUIRE(pool[7].value == 70);
+    REQUIRE(pool.nextIndex() == 3);
+    pool.create(30);
+    REQUIRE(pool.nextIndex() == 10);
+    REQUIRE(pool.size() == 10);
+
+    pool.destroy(0);
+    pool.clear();
+    REQUIRE(Counted::alive == 0);
+}
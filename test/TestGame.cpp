@@ -2,22 +2,34 @@
 #include "TestGame.hpp"
 #include "catch2/catch.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
 static const int TEST_GAME_MCTS_ITERATIONS = 10000;
 
+/** Hashes actions by their choice, so the same choice shares its history at every turn */
+class ChoiceHash : public ActionHash<TestGameAction> {
+public:
+    std::size_t hash(const TestGameAction& action) override { return action.getChoice(); }
+};
+
 /**
  * Play a game with the given number of turns and maximum number to choose.
  *
  * The resulting game has maxChoice^numTurns possible solutions.
  *
- * The MCTS used is deterministic. It runs for a set number of iterations and TestGamePlayoutStrategy uses a constant
- * seed for generating random moves.
+ * The MCTS used is deterministic. It runs for a set number of iterations and generates random moves with a
+ * generator that has a constant seed.
  *
  * @param numTurns the number of turns (the depth of the game tree)
  * @param maxChoice the maximum number per choice (the number of children per game tree node)
  * @param seed the seed for the generator used to generate the sequence MCTS should guess.
+ * @param progressiveHistory use progressive history with the choice as hash of an action
+ * @param rave use RAVE with the choice as hash of an action
  * @return the score MCTS achieved.
  */
-float playGame(uint numTurns, uint maxChoice, int seed)
+float playGame(uint numTurns, uint maxChoice, int seed, bool progressiveHistory = false, bool rave = false)
 {
     auto state = TestGameState(numTurns, maxChoice);
 
@@ -38,8 +50,57 @@ float playGame(uint numTurns, uint maxChoice, int seed)
         // Make MCTS deterministic by setting a required number of iterations instead of a time
         mcts.setTime(0);
         mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS);
+        if (progressiveHistory || rave)
+            mcts.setActionHash(new ChoiceHash());
+        if (!progressiveHistory)
+            mcts.setW(0);
+        if (rave)
+            mcts.setRave();
+        auto action = mcts.calculateAction();
+        action.execute(state);
+    }
+
+    TestGameScoring scoring(expectedSequence);
+    return scoring.score(state);
+}
+
+/**
+ * Play a game like playGame(), but with a single MCTS instance that keeps its tree between turns.
+ *
+ * @param numTurns the number of turns (the depth of the game tree)
+ * @param maxChoice the maximum number per choice (the number of children per game tree node)
+ * @param seed the seed for the generator used to generate the sequence MCTS should guess.
+ * @return the score MCTS achieved.
+ */
+float playGameReusingTree(uint numTurns, uint maxChoice, int seed)
+{
+    auto state = TestGameState(numTurns, maxChoice);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<uint> distribution(0, maxChoice);
+
+    std::vector<uint> expectedSequence(state.getNumTurns());
+    for (auto& entry : expectedSequence) {
+        entry = distribution(generator);
+    }
+
+    TestGameMCTS mcts(state, new TestGameBackPropagation(), new TestGameTerminationCheck(),
+        new TestGameScoring(expectedSequence));
+    mcts.setTime(0);
+    mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS);
+
+    for (int i = 0; i < state.getNumTurns(); i++) {
         auto action = mcts.calculateAction();
         action.execute(state);
+
+        int visitsBefore = mcts.getRoot().getNumVisits();
+        bool reused = mcts.advance(action);
+
+        // The chosen action is always expanded, its statistics should survive the move
+        REQUIRE(reused);
+        REQUIRE(mcts.getRoot().getNumVisits() > 0);
+        REQUIRE(mcts.getRoot().getNumVisits() < visitsBefore);
+        REQUIRE(mcts.getNode(mcts.getRootIndex()).getParent() == NO_NODE);
     }
 
     TestGameScoring scoring(expectedSequence);
@@ -65,3 +126,501 @@ TEST_CASE("MCTS wins a simple game")
         REQUIRE(playGame(10, 5, seed) == 1.0F);
     }
 }
+
+TEST_CASE("MCTS with progressive history wins a simple game")
+{
+    int seed = GENERATE(range(1, 6));
+
+    REQUIRE(playGame(10, 5, seed, true) == 1.0F);
+}
+
+/** Hashes actions like ChoiceHash and counts the hashed actions */
+class CountingHash : public ActionHash<TestGameAction> {
+    int& count;
+
+public:
+    explicit CountingHash(int& count)
+        : count(count)
+    {
+    }
+
+    std::size_t hash(const TestGameAction& action) override
+    {
+        count++;
+        return action.getChoice();
+    }
+};
+
+TEST_CASE("progressive history credits the actions of the playout")
+{
+    int hashed = 0;
+    auto mcts = makeTestGameMCTS(TestGameState(10, 5), 1);
+    mcts.setActionHash(new CountingHash(hashed));
+
+    mcts.search();
+
+    // The root is not expanded in the first iteration, so its playout plays all 10 turns
+    REQUIRE(mcts.getIterations() == 1);
+    REQUIRE(hashed == 10);
+}
+
+TEST_CASE("progressive history rejects tables it cannot index")
+{
+    auto mcts = makeTestGameMCTS(TestGameState(10, 5), 1);
+
+    REQUIRE_THROWS_AS(mcts.setActionHash(new ChoiceHash(), 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(mcts.setActionHash(new ChoiceHash(), 33), std::invalid_argument);
+}
+
+TEST_CASE("MCTS with RAVE wins a simple game")
+{
+    int seed = GENERATE(range(1, 6));
+
+    SECTION("RAVE alone")
+    {
+        REQUIRE(playGame(10, 5, seed, false, true) == 1.0F);
+    }
+
+    SECTION("RAVE with progressive history")
+    {
+        REQUIRE(playGame(10, 5, seed, true, true) == 1.0F);
+    }
+}
+
+TEST_CASE("RAVE requires an ActionHash")
+{
+    TestGameMCTS mcts(TestGameState(2, 1), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+        new TestGameScoring({ 0, 0 }));
+    mcts.setRave();
+
+    REQUIRE_THROWS_AS(mcts.calculateAction(), std::logic_error);
+}
+
+TEST_CASE("the MCTS-Solver stops searching once the root is proven")
+{
+    SECTION("a proven win decides a node right away")
+    {
+        TestGameMCTS mcts(TestGameState(4, 2), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+            new TestGameScoring({ 2, 0, 1, 2 }));
+        mcts.setSolver(true);
+        mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS * 10);
+
+        REQUIRE(mcts.calculateAction() == TestGameAction(2));
+        REQUIRE(mcts.isSolved());
+        REQUIRE(mcts.getRoot().getSolvedResult() == 1.0F);
+        // The game has only 3^4 = 81 terminal states
+        REQUIRE(mcts.getIterations() < TEST_GAME_MCTS_ITERATIONS);
+    }
+
+    SECTION("a node is decided by the best of its children once all are proven")
+    {
+        // The last number can never be guessed, so no terminal state is a win
+        TestGameMCTS mcts(TestGameState(3, 1), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+            new TestGameScoring({ 1, 0, 5 }));
+        mcts.setSolver(true);
+        mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS * 10);
+
+        REQUIRE(mcts.calculateAction() == TestGameAction(1));
+        REQUIRE(mcts.isSolved());
+        REQUIRE(mcts.getRoot().getSolvedResult() == Approx(2.0F / 3.0F));
+        REQUIRE(mcts.getIterations() < TEST_GAME_MCTS_ITERATIONS);
+    }
+}
+
+TEST_CASE("MCTS wins a simple game while reusing its tree")
+{
+    int seed = GENERATE(range(1, 4));
+
+    REQUIRE(playGameReusingTree(10, 5, seed) == 1.0F);
+}
+
+TEST_CASE("MCTS starts a new tree for actions it has not expanded")
+{
+    TestGameMCTS mcts(TestGameState(3, 2), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+        new TestGameScoring({ 0, 0, 0 }));
+
+    REQUIRE_FALSE(mcts.advance(TestGameAction(1)));
+    REQUIRE(mcts.getNumNodes() == 1);
+    REQUIRE(mcts.getRoot().getData().getChoices() == std::vector<uint> { 1 });
+}
+
+TEST_CASE("MCTS searches a new root after a reset")
+{
+    auto mcts = makeTestGameMCTS(TestGameState(10, 5), TEST_GAME_MCTS_ITERATIONS);
+    REQUIRE(mcts.calculateAction() == TestGameAction(3));
+    REQUIRE(mcts.getNumNodes() > 1);
+
+    TestGameState next(10, 5);
+    next.addChoice(3);
+    mcts.reset(next);
+
+    REQUIRE(mcts.getNumNodes() == 1);
+    REQUIRE(mcts.getIterations() == 0);
+    REQUIRE(mcts.getRoot().getData().getChoices() == std::vector<uint> { 3 });
+    REQUIRE(mcts.calculateAction() == TestGameAction(1));
+}
+
+/**
+ * Treats states with the same chosen numbers in a different order as equal, which turns the game tree into a graph.
+ */
+class OrderlessHash : public StateHash<TestGameState> {
+public:
+    std::size_t hash(const TestGameState& state) override
+    {
+        std::size_t result = state.getChoices().size();
+        for (uint choice : state.getChoices())
+            result += std::hash<uint>()(choice) * 31;
+        return result;
+    }
+
+    bool equals(const TestGameState& a, const TestGameState& b) override
+    {
+        auto choicesA = a.getChoices();
+        auto choicesB = b.getChoices();
+        std::sort(choicesA.begin(), choicesA.end());
+        std::sort(choicesB.begin(), choicesB.end());
+        return choicesA == choicesB;
+    }
+};
+
+TEST_CASE("transpositions share nodes")
+{
+    auto backup = GENERATE(TranspositionBackup::EDGE, TranspositionBackup::NODE);
+
+    // Every sequence of choices is a win, so scores do not depend on the order of the choices
+    TestGameMCTS mcts(TestGameState(10, 1), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+        new TestGameScoring(std::vector<uint>(10, 0)));
+    mcts.setTranspositions(new OrderlessHash(), backup);
+    mcts.setTime(0);
+    mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS);
+    mcts.calculateAction();
+
+    // There are only 66 distinct sets of up to 10 choices of 0 or 1, against 2047 sequences
+    REQUIRE(mcts.getNumNodes() <= 66);
+
+    // The node reached by (0, 1) is also reached by (1, 0)
+    const auto& root = mcts.getRoot();
+    const auto& first = mcts.getNode(root.getChildren()[0]);
+    const auto& second = mcts.getNode(root.getChildren()[1]);
+    REQUIRE(first.getChildren()[1] == second.getChildren()[0]);
+
+    SECTION("shared nodes survive moving the root")
+    {
+        REQUIRE(mcts.advance(TestGameAction(0)));
+        REQUIRE(mcts.getNumNodes() <= 55);
+        REQUIRE_FALSE(mcts.getRoot().getChildren().empty());
+    }
+}
+
+TEST_CASE("shared nodes keep the action of every parent")
+{
+    auto path = GENERATE(std::vector<uint> { 0, 1 }, std::vector<uint> { 1, 0 });
+
+    // The score depends on the order of the choices, so the best action differs between the parents of a shared node
+    TestGameMCTS mcts(TestGameState(6, 2), new TestGameBackPropagation(), new TestGameTerminationCheck(),
+        new TestGameScoring({ 1, 0, 2, 1, 0, 2 }));
+    mcts.setTranspositions(new OrderlessHash());
+    mcts.setTime(0);
+    mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS);
+    mcts.search();
+
+    for (uint choice : path) {
+        REQUIRE(mcts.advance(TestGameAction(choice)));
+
+        std::vector<uint> actions;
+        for (const auto& statistics : mcts.getRootStatistics())
+            actions.push_back(statistics.action.getChoice());
+        std::sort(actions.begin(), actions.end());
+        REQUIRE(actions == std::vector<uint> { 0, 1, 2 });
+    }
+
+    // Both paths end at the node shared by (0, 1) and (1, 0)
+    auto choices = mcts.getRoot().getData().getChoices();
+    std::sort(choices.begin(), choices.end());
+    REQUIRE(choices == std::vector<uint> { 0, 1 });
+}
+
+TEST_CASE("MCTS stays within its node limit")
+{
+    auto policy = GENERATE(MemoryLimitPolicy::STOP_EXPANDING, MemoryLimitPolicy::EVICT_LEAST_VISITED,
+        MemoryLimitPolicy::EVICT_LEAST_RECENT);
+
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), TEST_GAME_MCTS_ITERATIONS);
+    mcts.setMaxNodes(100, policy);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(mcts.getNumNodes() <= 100);
+    REQUIRE(action == TestGameAction(3));
+    if (policy == MemoryLimitPolicy::STOP_EXPANDING) {
+        REQUIRE(mcts.getNumEvicted() == 0);
+    } else {
+        REQUIRE(mcts.getNumEvicted() > 0);
+    }
+
+    SECTION("the root can move after nodes were evicted")
+    {
+        REQUIRE(mcts.advance(action));
+        REQUIRE(mcts.getRoot().getData().getChoices() == std::vector<uint> { 3 });
+    }
+}
+
+TEST_CASE("MCTS rebuilds the states it does not store")
+{
+    auto storage = GENERATE(StateStorage::REPLAY, StateStorage::CHECKPOINT);
+
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(5, 5), TEST_GAME_MCTS_ITERATIONS);
+    mcts.setStateStorage(storage, 2);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(mcts.getNumStoredStates() < mcts.getNumNodes());
+    if (storage == StateStorage::REPLAY)
+        REQUIRE(mcts.getNumStoredStates() == 1);
+
+    REQUIRE(mcts.advance(action));
+    REQUIRE(mcts.getRoot().getData().getChoices() == std::vector<uint> { 3 });
+    REQUIRE(mcts.calculateAction() == TestGameAction(1));
+}
+
+TEST_CASE("MCTS creates the nodes of children on their second visit")
+{
+    TestGameMCTS eager = makeTestGameMCTS(TestGameState(10, 5), TEST_GAME_MCTS_ITERATIONS);
+    TestGameMCTS lazy = makeTestGameMCTS(TestGameState(10, 5), TEST_GAME_MCTS_ITERATIONS);
+    lazy.setLazyChildren(true);
+
+    REQUIRE(eager.calculateAction() == TestGameAction(3));
+    auto action = lazy.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(lazy.getNumNodes() < eager.getNumNodes());
+    REQUIRE(lazy.getRoot().getNumVisits() == TEST_GAME_MCTS_ITERATIONS);
+
+    // Playouts are counted at the root's children whether they have a node or not
+    const auto& eagerVisits = eager.getRoot().getChildVisits();
+    const auto& lazyVisits = lazy.getRoot().getChildVisits();
+    REQUIRE(std::accumulate(lazyVisits.begin(), lazyVisits.end(), 0)
+        == std::accumulate(eagerVisits.begin(), eagerVisits.end(), 0));
+
+    REQUIRE(lazy.advance(action));
+    REQUIRE(lazy.calculateAction() == TestGameAction(1));
+}
+
+/**
+ * Generates all choices at once.
+ */
+class TestGameBatchExpansionStrategy : public TestGameExpansionStrategy {
+public:
+    using TestGameExpansionStrategy::TestGameExpansionStrategy;
+
+    void generateAll(std::vector<TestGameAction>& actions)
+    {
+        for (uint choice = 0; choice <= state->getMaxChoice(); choice++)
+            actions.emplace_back(choice);
+    }
+};
+
+TEST_CASE("MCTS adds all children at once when the ExpansionStrategy generates all actions")
+{
+    bool lazy = GENERATE(false, true);
+
+    // The root is expanded in the sixth iteration
+    auto mcts = makeTestGameMCTS<MCTS<TestGameState, TestGameAction, TestGameBatchExpansionStrategy, TestGamePlayoutStrategy>>(
+        TestGameState(10, 5), 6);
+    mcts.setLazyChildren(lazy);
+
+    mcts.search();
+    REQUIRE(mcts.getRoot().getChildren().size() == 6);
+    REQUIRE_FALSE(mcts.getRoot().hasExpansion());
+    REQUIRE(mcts.getNumNodes() == (lazy ? 1 : 7));
+
+    mcts.setMinIterations(TEST_GAME_MCTS_ITERATIONS);
+    REQUIRE(mcts.calculateAction() == TestGameAction(3));
+}
+
+/**
+ * Plays whole playouts at once, scoring them like TestGameScoring with TEST_GAME_SEQUENCE.
+ */
+class TestGameRolloutStrategy : public TestGamePlayoutStrategy {
+public:
+    static int numRollouts;
+
+    using TestGamePlayoutStrategy::TestGamePlayoutStrategy;
+
+    float rollout(TestGameState& rolloutState, std::mt19937& generator)
+    {
+        numRollouts++;
+        std::uniform_int_distribution<uint> distribution(0, rolloutState.getMaxChoice());
+        while (rolloutState.getChoices().size() < rolloutState.getNumTurns())
+            rolloutState.addChoice(distribution(generator));
+        return TestGameScoring(TEST_GAME_SEQUENCE).score(rolloutState);
+    }
+};
+
+int TestGameRolloutStrategy::numRollouts = 0;
+
+TEST_CASE("MCTS uses the rollout of the PlayoutStrategy when available")
+{
+    auto mcts = makeTestGameMCTS<MCTS<TestGameState, TestGameAction, TestGameExpansionStrategy, TestGameRolloutStrategy>>(
+        TestGameState(5, 5), 2000);
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameAction(3));
+    // Iterations ending in a terminal node do not play out
+    REQUIRE(TestGameRolloutStrategy::numRollouts > 0);
+    REQUIRE(TestGameRolloutStrategy::numRollouts <= 2000);
+}
+
+TEST_CASE("MCTS stops close to a hard deadline")
+{
+    TestGameMCTS mcts = makeTestGameMCTS(TestGameState(10, 5), std::numeric_limits<int>::max());
+    mcts.setTime(20);
+    mcts.setTimeSlack(std::chrono::milliseconds(1));
+    mcts.setHardDeadline(true);
+
+    mcts.search();
+
+    REQUIRE(mcts.getIterations() > 0);
+    REQUIRE(mcts.getIterations() < (unsigned int)std::numeric_limits<int>::max());
+    REQUIRE(mcts.getOvershoot() >= std::chrono::microseconds(0));
+    // Generous bound for loaded machines, the slack itself is 1 ms
+    REQUIRE(mcts.getOvershoot() < std::chrono::milliseconds(15));
+}
+
+TEST_CASE("MCTS with concrete policy types matches MCTS with virtual policies")
+{
+    TestGameMCTS virtualMCTS = makeTestGameMCTS(TestGameState(10, 5), 2000);
+    // Concrete policies can be passed by value
+    TestGameStaticMCTS staticMCTS(TestGameState(10, 5), TestGameBackPropagation(), TestGameTerminationCheck(),
+        TestGameScoring(TEST_GAME_SEQUENCE));
+    staticMCTS.setTime(0);
+    staticMCTS.setMinIterations(2000);
+
+    auto action = staticMCTS.calculateAction();
+
+    // Both search exactly the same way
+    REQUIRE(action == virtualMCTS.calculateAction());
+    REQUIRE(action == TestGameAction(3));
+    REQUIRE(staticMCTS.getNumNodes() == virtualMCTS.getNumNodes());
+    REQUIRE(staticMCTS.getRoot().getAvgScore() == virtualMCTS.getRoot().getAvgScore());
+}
+
+/**
+ * Keeps track of the number of live instances.
+ */
+class CountedExpansionStrategy : public TestGameExpansionStrategy {
+public:
+    static int live;
+
+    explicit CountedExpansionStrategy(TestGameState* state)
+        : TestGameExpansionStrategy(state)
+    {
+        live++;
+    }
+
+    CountedExpansionStrategy(const CountedExpansionStrategy& other)
+        : TestGameExpansionStrategy(other)
+    {
+        live++;
+    }
+
+    ~CountedExpansionStrategy() override { live--; }
+};
+
+int CountedExpansionStrategy::live = 0;
+
+TEST_CASE("MCTS only keeps expansion strategies of partially expanded nodes")
+{
+    using CountedMCTS = MCTS<TestGameState, TestGameAction, CountedExpansionStrategy, TestGamePlayoutStrategy>;
+    {
+        auto mcts = makeTestGameMCTS<CountedMCTS>(TestGameState(10, 5), 3000);
+        mcts.search();
+
+        REQUIRE_FALSE(mcts.getRoot().hasExpansion());
+        REQUIRE_FALSE(mcts.getRoot().shouldExpand());
+
+        int partiallyExpanded = 0;
+        std::vector<NodeIndex> stack { mcts.getRootIndex() };
+        while (!stack.empty()) {
+            const auto& node = mcts.getNode(stack.back());
+            stack.pop_back();
+            partiallyExpanded += node.hasExpansion() ? 1 : 0;
+            stack.insert(stack.end(), node.getChildren().begin(), node.getChildren().end());
+        }
+
+        REQUIRE(CountedExpansionStrategy::live == partiallyExpanded);
+        REQUIRE(CountedExpansionStrategy::live < (int)mcts.getNumNodes() / 2);
+
+        // Moved expansion strategies keep working after the tree is compacted
+        mcts.advance(TestGameAction(3));
+        mcts.search();
+        REQUIRE(mcts.getBestAction() == TestGameAction(1));
+    }
+    REQUIRE(CountedExpansionStrategy::live == 0);
+}
+
+/**
+ * A TestGameAction that can be undone, counting how often it is.
+ */
+class TestGameUndoableAction : public TestGameAction {
+public:
+    static int numUndone;
+
+    using TestGameAction::TestGameAction;
+
+    void undo(TestGameState& state)
+    {
+        numUndone++;
+        state.removeChoice();
+    }
+};
+
+int TestGameUndoableAction::numUndone = 0;
+
+class TestGameUndoableExpansionStrategy : public ExpansionStrategy<TestGameState, TestGameUndoableAction> {
+    using ExpansionStrategy<TestGameState, TestGameUndoableAction>::ExpansionStrategy;
+
+    uint currentChoice = 0;
+
+public:
+    TestGameUndoableAction generateNext() override { return TestGameUndoableAction(currentChoice++); }
+
+    bool canGenerateNext() const override { return currentChoice <= state->getMaxChoice(); }
+};
+
+class TestGameUndoablePlayoutStrategy : public PlayoutStrategy<TestGameState, TestGameUndoableAction> {
+    std::uniform_int_distribution<uint> distribution;
+
+public:
+    explicit TestGameUndoablePlayoutStrategy(TestGameState* state)
+        : PlayoutStrategy(state)
+        , distribution(0, state->getMaxChoice())
+    {
+    }
+
+    void generateRandom(TestGameUndoableAction& action) override { action.setChoice(distribution(*rng)); }
+};
+
+TEST_CASE("MCTS undoes actions on a single working state")
+{
+    auto storage = GENERATE(StateStorage::FULL, StateStorage::REPLAY);
+
+    auto mcts = makeTestGameMCTS<
+        MCTS<TestGameState, TestGameUndoableAction, TestGameUndoableExpansionStrategy, TestGameUndoablePlayoutStrategy>>(
+        TestGameState(5, 5), TEST_GAME_MCTS_ITERATIONS);
+    mcts.setStateStorage(storage);
+    TestGameUndoableAction::numUndone = 0;
+
+    auto action = mcts.calculateAction();
+
+    REQUIRE(action == TestGameUndoableAction(3));
+    // Every iteration plays until the end of the game and undoes all five choices
+    REQUIRE(TestGameUndoableAction::numUndone == 5 * (int)mcts.getIterations());
+    if (storage == StateStorage::REPLAY)
+        REQUIRE(mcts.getNumStoredStates() == 1);
+
+    REQUIRE(mcts.advance(action));
+    REQUIRE(mcts.calculateAction() == TestGameUndoableAction(1));
+}
@@ -49,6 +49,11 @@ public:
      */
     void addChoice(uint choice) { choices.push_back(choice); }
 
+    /**
+     * @brief Remove the last chosen number, going back one turn.
+     */
+    void removeChoice() { choices.pop_back(); }
+
     /**
      * @brief Get the total number of turns in the game.
      *
@@ -92,7 +97,11 @@ public:
 
     void execute(TestGameState& state) override { state.addChoice(choice); }
 
+    uint getChoice() const { return choice; }
+
     void setChoice(uint newChoice) { this->choice = newChoice; }
+
+    bool operator==(const TestGameAction& other) const { return choice == other.choice; }
 };
 
 /**
@@ -114,7 +123,6 @@ public:
  */
 class TestGamePlayoutStrategy : public PlayoutStrategy<TestGameState, TestGameAction> {
 private:
-    std::mt19937 generator = std::mt19937(42);
     std::uniform_int_distribution<uint> distribution;
 
 public:
@@ -124,7 +132,7 @@ public:
     {
     }
 
-    void generateRandom(TestGameAction& action) override { action.setChoice(distribution(generator)); }
+    void generateRandom(TestGameAction& action) override { action.setChoice(distribution(*rng)); }
 };
 
 /**
@@ -182,4 +190,34 @@ public:
  */
 using TestGameMCTS = MCTS<TestGameState, TestGameAction, TestGameExpansionStrategy, TestGamePlayoutStrategy>;
 
+/**
+ * @brief Like TestGameMCTS, but with the policies passed as template parameters so their calls can be inlined.
+ */
+using TestGameStaticMCTS = MCTS<TestGameState, TestGameAction, TestGameExpansionStrategy, TestGamePlayoutStrategy,
+    TestGameBackPropagation, TestGameTerminationCheck, TestGameScoring>;
+
+/**
+ * @brief The sequence most tests search for, the best first choice is 3.
+ */
+const std::vector<uint> TEST_GAME_SEQUENCE { 3, 1, 4, 1, 5, 0, 2, 5, 3, 5 };
+
+/**
+ * @brief Create an MCTS agent looking for TEST_GAME_SEQUENCE that runs a fixed number of iterations.
+ *
+ * Searching for a number of iterations instead of a time makes the search deterministic.
+ *
+ * @tparam M The MCTS type, using the policies from this header
+ * @param state the state to search from, with at most 10 turns
+ * @param iterations the number of iterations of every search
+ * @return the MCTS agent
+ */
+template <class M = TestGameMCTS>
+M makeTestGameMCTS(const TestGameState& state, int iterations)
+{
+    M mcts(state, new TestGameBackPropagation(), new TestGameTerminationCheck(), new TestGameScoring(TEST_GAME_SEQUENCE));
+    mcts.setTime(0);
+    mcts.setMinIterations(iterations);
+    return mcts;
+}
+
 #endif // CPP_MCTS_TESTGAME_HPP
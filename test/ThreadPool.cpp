@@ -0,0 +1,102 @@
+#include "catch2/catch.hpp"
+#include "mcts/threadpool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("thread pools run every call of a batch once")
+{
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> calls(1000);
+    for (auto& count : calls)
+        count = 0;
+
+    pool.run(calls.size(), [&calls](std::size_t i) { calls[i]++; });
+
+    for (const auto& count : calls)
+        REQUIRE(count == 1);
+}
+
+TEST_CASE("thread pools without workers run batches on the calling thread")
+{
+    ThreadPool pool(0);
+    int sum = 0;
+
+    pool.run(10, [&sum](std::size_t i) { sum += (int)i; });
+
+    REQUIRE(sum == 45);
+}
+
+TEST_CASE("thread pools finish submitted tasks before they are destroyed")
+{
+    std::atomic<int> done { 0 };
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 100; i++)
+            pool.submit([&done]() { done++; });
+    }
+
+    REQUIRE(done == 100);
+}
+
+TEST_CASE("thread pools run tasks submitted by their workers")
+{
+    std::atomic<int> done { 0 };
+    {
+        ThreadPool pool(4);
+        for (int i = 0; i < 10; i++) {
+            pool.submit([&pool, &done]() {
+                for (int j = 0; j < 10; j++)
+                    pool.submit([&done]() { done++; });
+            });
+        }
+    }
+
+    REQUIRE(done == 100);
+}
+
+TEST_CASE("thread pools run batches started by their workers")
+{
+    ThreadPool pool(2);
+    std::vector<std::atomic<int>> calls(4 * 100);
+    for (auto& count : calls)
+        count = 0;
+
+    pool.run(4, [&pool, &calls](std::size_t i) {
+        pool.run(100, [&calls, i](std::size_t j) { calls[i * 100 + j]++; });
+    });
+
+    for (const auto& count : calls)
+        REQUIRE(count == 1);
+}
+
+TEST_CASE("thread pools report the tasks run by every worker")
+{
+    ThreadPool pool(3, true);
+    for (int i = 0; i < 50; i++)
+        pool.submit([]() {});
+
+    // Tasks are counted after they return, wait until all of them were
+    std::uint64_t tasks = 0;
+    while (tasks < 50) {
+        std::this_thread::yield();
+        tasks = 0;
+        for (const auto& worker : pool.getWorkerStatistics())
+            tasks += worker.tasks;
+    }
+
+    auto statistics = pool.getWorkerStatistics();
+    REQUIRE(statistics.size() == 3);
+    for (const auto& worker : statistics) {
+        REQUIRE(worker.stolen <= worker.tasks);
+        REQUIRE(worker.utilization >= 0.0);
+        REQUIRE(worker.utilization <= 1.0);
+    }
+    REQUIRE(tasks == 50);
+
+    pool.resetStatistics();
+    for (const auto& worker : pool.getWorkerStatistics())
+        REQUIRE(worker.tasks == 0);
+}
@@ -0,0 +1,46 @@
+#include "catch2/catch.hpp"
+#include "mcts/uct.hpp"
+
+#include <random>
+#include <vector>
+
+TEST_CASE("vector UCT kernels agree with the scalar kernel")
+{
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> visitDistribution(0, 50);
+    std::uniform_real_distribution<float> scoreDistribution(0.0F, 1.0F);
+
+    // Cover sizes below, at and above the vector widths
+    std::size_t n = GENERATE(1, 3, 4, 7, 8, 9, 31, 150);
+
+    std::vector<float> scoreSums(n);
+    std::vector<int> visits(n);
+    for (std::size_t i = 0; i < n; i++) {
+        visits[i] = visitDistribution(generator) + 1;
+        scoreSums[i] = scoreDistribution(generator) * (float)visits[i];
+    }
+
+    float logN = std::log(1000.0F);
+    std::size_t expected = UCT::selectScalar(scoreSums.data(), visits.data(), n, logN, 0.5F);
+
+    REQUIRE(UCT::select(scoreSums.data(), visits.data(), n, logN, 0.5F) == expected);
+#if defined(CPP_MCTS_X86)
+    REQUIRE(UCT::selectSSE2(scoreSums.data(), visits.data(), n, logN, 0.5F) == expected);
+#endif
+
+    SECTION("unvisited children are selected first")
+    {
+        visits[n - 1] = 0;
+        scoreSums[n - 1] = 0.0F;
+
+        REQUIRE(UCT::select(scoreSums.data(), visits.data(), n, logN, 0.5F) == n - 1);
+    }
+
+    SECTION("ties select the first child")
+    {
+        std::fill(visits.begin(), visits.end(), 10);
+        std::fill(scoreSums.begin(), scoreSums.end(), 5.0F);
+
+        REQUIRE(UCT::select(scoreSums.data(), visits.data(), n, logN, 0.5F) == 0);
+    }
+}